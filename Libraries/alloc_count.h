@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+// Contagem de alocações do heap para conferir que o laço principal não aloca.
+//
+// Com PARTICLE_COUNT_ALLOCS (make <alvo> ALLOCS=1), alloc_count.cpp substitui os
+// operator new/delete globais por versões que somam cada alocação (de qualquer thread,
+// incluindo o pool do World e o consumidor do CollisionLog) antes de chamar malloc.
+// Sem a definição nada é substituído e allocationStats devolve sempre zero.
+struct AllocStats{
+    uint64_t count; // Chamadas de operator new desde o início do programa
+    uint64_t bytes;
+};
+
+bool allocationCountingEnabled();
+AllocStats allocationStats();
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// O que acontece com uma particula que passa dos limites do mundo.
+enum class Boundary{
+    Reflect,  // Inverte a componente da direção que aponta para fora (padrão)
+    Periodic, // Reaparece do lado oposto, com a mesma direção
+    Absorb,   // Sai do World no fim do passo, como em um segmento absorvente
+    Clamp     // Fica no limite e perde só a componente que aponta para fora (desliza)
+};
+
+// Confere um byte lido de arquivo antes de convertê-lo em Boundary.
+inline bool validBoundary(uint8_t v){ return v <= static_cast<uint8_t>(Boundary::Clamp); }
+
+// Nome usado na linha de comando ("reflect", "periodic", "absorb", "clamp").
+inline bool parseBoundary(const char* name, Boundary& out){
+    const char* names[] = {"reflect", "periodic", "absorb", "clamp"};
+    for(int b = 0; b < 4; ++b){
+        if(std::strcmp(name, names[b]) == 0){
+            out = static_cast<Boundary>(b);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Políticas de limite do passo Discrete. Cada uma trata um eixo de cada vez com
+// comparações e seleções, sem desvios, para o compilador vetorizar o laço de
+// World::applyLimits<Policy>; a escolha da política é feita uma vez, em setBoundary.
+// lo/hi são os limites do eixo; p é a posição e v a direção nesse eixo.
+// RETIRES indica que a política retira as particulas que saem: applyLimits zera a vida
+// de quem apply marcou como fora, e o passo as remove junto com as expiradas.
+struct ReflectBoundary{
+    static constexpr bool RETIRES = false;
+    static void apply(double& x, double& y, double& dx, double& dy, double xMin, double xMax, double yMin, double yMax){
+        axis(x, dx, xMin, xMax);
+        axis(y, dy, yMin, yMax);
+    }
+    static void axis(double p, double& v, double lo, double hi){
+        const bool out = (p <= lo && v < 0.0) || (p >= hi && v > 0.0);
+        v = out ? -v : v;
+    }
+};
+
+struct PeriodicBoundary{
+    static constexpr bool RETIRES = false;
+    static void apply(double& x, double& y, double&, double&, double xMin, double xMax, double yMin, double yMax){
+        axis(x, xMin, xMax);
+        axis(y, yMin, yMax);
+    }
+    // Quantas voltas forem precisas (speed * dt pode passar da largura do mundo). Dentro
+    // dos limites floor dá 0 e p não muda; a última seleção cobre o arredondamento de
+    // p um pouco abaixo de lo, que pode cair exatamente em hi.
+    static void axis(double& p, double lo, double hi){
+        const double w = hi - lo;
+        p -= w * std::floor((p - lo) / w);
+        p = p >= hi ? lo : p;
+    }
+};
+
+struct ClampBoundary{
+    static constexpr bool RETIRES = false;
+    static void apply(double& x, double& y, double& dx, double& dy, double xMin, double xMax, double yMin, double yMax){
+        axis(x, dx, xMin, xMax);
+        axis(y, dy, yMin, yMax);
+    }
+    static void axis(double& p, double& v, double lo, double hi){
+        const bool out = (p <= lo && v < 0.0) || (p >= hi && v > 0.0);
+        v = out ? 0.0 : v;
+        p = std::min(std::max(p, lo), hi);
+    }
+};
+
+// Para na parede (no limite, com dx = dy = 0) e é retirada no fim do passo.
+struct AbsorbBoundary{
+    static constexpr bool RETIRES = true;
+    static bool apply(double& x, double& y, double& dx, double& dy, double xMin, double xMax, double yMin, double yMax){
+        const bool out = x < xMin || x > xMax || y < yMin || y > yMax;
+        dx = out ? 0.0 : dx;
+        dy = out ? 0.0 : dy;
+        x = std::min(std::max(x, xMin), xMax);
+        y = std::min(std::max(y, yMin), yMax);
+        return out;
+    }
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "point.h"
+#include "segment_table.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Nó da BVH. Folhas guardam [first, first + count) em leafSegs; nós internos
+// guardam o filho esquerdo em first (o direito é sempre first + 1).
+struct BVHNode{
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+    uint32_t first;
+    uint32_t count; // 0 --> nó interno
+};
+
+// Hierarquia de caixas (AABB) sobre os segmentos, construída com SAH (Surface Area Heuristic,
+// aqui o perímetro das caixas em 2D) e guardada em um array plano de nós em pré-ordem.
+// Melhor que a SegmentGrid quando a densidade de segmentos é muito desigual.
+class SegmentBVH{
+
+private:
+    std::vector<BVHNode> nodes;
+    std::vector<SegmentEntry> leafSegs; // segmentos (com os termos da reta) na ordem das folhas
+    std::vector<uint32_t> leafIds;  // índice original de cada segmento das folhas
+
+    void subdivide(uint32_t index, std::vector<uint32_t>& ids, std::vector<double>& cx, std::vector<double>& cy,
+                   const std::vector<ponto2D>& segs, size_t begin, size_t end, int depth);
+
+public:
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;
+    static constexpr int MAX_DEPTH = 64;
+    static constexpr uint32_t NO_HIT = 0xFFFFFFFFu;
+
+    // segs segue o formato do World: cada par (2i, 2i+1) é o segmento i.
+    void build(const std::vector<ponto2D>& segs);
+
+    // Segmento atingido primeiro pelo caminho p --> q (NO_HIT se nenhum).
+    // t recebe a fração do caminho até o contato; exclude é ignorado nos testes.
+    uint32_t nearestHit(const ponto2D& p, const ponto2D& q, double& t, uint32_t exclude = NO_HIT) const;
+
+    bool empty() const { return nodes.empty(); }
+    size_t nodeCount() const { return nodes.size(); }
+    size_t memoryBytes() const;
+};
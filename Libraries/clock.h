@@ -0,0 +1,33 @@
+#pragma once
+
+// Relógio de passo fixo: acumula o tempo real de cada frame e converte em um número
+// inteiro de passos de dt fixo, então a trajetória não depende da taxa de quadros.
+// Cada passo fixo pode ser dividido em substeps chamadas de World::step, e no máximo
+// maxCatchUp passos fixos rodam por frame (o tempo excedente é descartado, para um
+// frame lento não gerar uma avalanche de passos nos frames seguintes).
+class SimulationClock{
+
+private:
+    double dt;
+    int substeps;
+    int maxCatchUp;
+    double accumulator;
+    unsigned long ticks;    // passos fixos executados
+    double droppedTime;     // tempo descartado pelo limite de recuperação
+
+public:
+    SimulationClock(double dt, int substeps = 1, int maxCatchUp = 8);
+
+    // Soma frameSeconds e devolve quantas vezes chamar World::step(get_stepDt()).
+    int advance(double frameSeconds);
+
+    double get_dt() const;      // dt de um passo fixo
+    double get_stepDt() const;  // dt de cada chamada de World::step (dt / substeps)
+    int get_substeps() const;
+    unsigned long get_ticks() const;
+    double get_droppedTime() const;
+    double get_time() const;    // tempo simulado total
+
+    // Fração de passo que sobrou no acumulador (0..1), útil para interpolar a renderização.
+    double alpha() const;
+};
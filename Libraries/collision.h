@@ -0,0 +1,43 @@
+#pragma once
+
+#include "point.h"
+#include "vectors.h"
+#include "vec.h"
+#include "segment_table.h"
+
+// Lida com o caso especial que o ponto Q é colinear ao segmento PR e verifica se
+// Q está dentro dos limites do segmento da reta
+bool onSegment(const ponto2D& p, const ponto2D& q, const ponto2D& r);
+
+// Usa Cross Product para verificar a orientação entre o ponto e o Segmento
+// 0 --> Colinear
+// 1 --> Sentido Horário
+// 2 --> Sentido Anti-Horário
+int orientation(const ponto2D& p, const ponto2D& q, const ponto2D& r);
+
+// Verifica se o segmento p1q1 cruza o segmento p2q2
+bool doIntersect(const ponto2D& p1, const ponto2D& q1, const ponto2D& p2, const ponto2D& q2);
+
+// doIntersect(p1, q1, s.a, s.b) usando os termos do segmento já guardados na tabela;
+// as respostas são as mesmas.
+bool segmentIntersect(const ponto2D& p1, const ponto2D& q1, const SegmentEntry& s);
+
+//Calcula a Normal de um Segmento de Reta
+vec3 calculateNormal(const ponto2D& a, const ponto2D& b);
+
+// Reflete uma direção usando a normal do segmento
+vec3 reflect(const vec3& dir, const vec3& normal);
+
+// Versões 2D (inline) de calculateNormal/reflect usadas no passo da simulação;
+// dão os mesmos valores que as de vec3.
+inline vec2 segmentNormal(const ponto2D& a, const ponto2D& b){
+    return vec2{b.y - a.y, a.x - b.x}.normalized();
+}
+
+constexpr vec2 reflect(const vec2& dir, const vec2& normal){
+    return dir.reflect(normal);
+}
+
+// Parâmetro t (entre 0 e 1) do primeiro ponto de contato ao longo de p1q1 com o segmento p2q2.
+// Só faz sentido quando doIntersect(p1, q1, p2, q2) é verdadeiro.
+double intersectionTime(const ponto2D& p1, const ponto2D& q1, const ponto2D& p2, const ponto2D& q2);
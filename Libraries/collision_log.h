@@ -0,0 +1,80 @@
+#pragma once
+
+#include "mpmc_ring.h"
+#include "particle_handles.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Uma colisão de particula com segmento, publicada pelo passo da simulação.
+struct CollisionEvent{
+    ParticleHandle particle; // handle da particula (World::findParticle dá o índice atual)
+    uint32_t segment;  // id do segmento em World::getSegmentTable (pontos 2*segment, 2*segment+1)
+    uint32_t slot;     // índice da particula no World no momento da colisão
+    double time;       // tempo simulado do contato (início do passo no modo Discrete)
+    double x;          // posição da particula no contato (Continuous) ou na detecção (Discrete)
+    double y;
+    double nx;         // normal unitária do segmento
+    double ny;
+};
+
+// Recebe as colisões do passo em uma MpmcRing e as consome fora do laço da simulação:
+// por uma thread de fundo (start/stop) ou por quem chamar drain. O consumo soma
+// contadores e, se houver arquivo, grava os eventos em um log binário. publish nunca
+// bloqueia: com a fila cheia o evento é descartado e contado em get_dropped.
+//
+// Formato do log: "PPCL", uint32 versão (2), uint32 sizeof(CollisionEvent), seguido
+// dos eventos crus na ordem de consumo (little-endian, como estão na memória).
+class CollisionLog{
+
+private:
+    MpmcRing<CollisionEvent> ring;
+    std::atomic<uint64_t> consumed;
+    std::atomic<uint64_t> dropped;
+    std::vector<uint64_t> segmentHits; // Só a thread consumidora escreve
+    std::FILE* file;
+    std::vector<CollisionEvent> batch; // Eventos esperando o fwrite
+    static constexpr size_t BATCH = 4096;
+
+    std::thread consumer;
+    std::atomic<bool> running;
+
+    void consume(const CollisionEvent& e);
+    void flushBatch();
+
+public:
+    static constexpr uint32_t FORMAT_VERSION = 2; // A versão 1 tinha só o índice da particula
+
+    explicit CollisionLog(size_t capacity = 1 << 16);
+    CollisionLog(const CollisionLog&) = delete;
+    CollisionLog& operator=(const CollisionLog&) = delete;
+    ~CollisionLog();
+
+    // Chamado pelas threads do passo.
+    void publish(const CollisionEvent& e){
+        if(!ring.tryPush(e)){
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Abre o log binário (antes de start/drain). false se o arquivo não pôde ser criado.
+    bool openFile(const char* path);
+
+    // Inicia a thread consumidora; stop esvazia a fila, termina a thread e fecha o arquivo.
+    void start();
+    void stop();
+
+    // Reserva os contadores de segmentCount segmentos (antes de start): sem isso o
+    // consumidor aloca ao ver um id de segmento maior que os anteriores.
+    void reserveSegments(size_t segmentCount);
+
+    // Consome o que estiver na fila na thread que chama (sem thread de fundo).
+    size_t drain();
+
+    uint64_t get_consumed() const;
+    uint64_t get_dropped() const;
+    // Colisões por segmento; só é seguro ler com a thread parada.
+    const std::vector<uint64_t>& getSegmentHits() const;
+};
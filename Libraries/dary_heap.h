@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Heap de mínimo D-ário em um array plano. Com D = 4 a árvore fica com metade da
+// altura de um heap binário e os filhos de um nó costumam cair na mesma linha de cache,
+// o que favorece filas de eventos com muitos push/pop.
+// Less(a, b) deve ser verdadeiro quando a tem prioridade sobre b.
+template<typename T, size_t D, typename Less>
+class DaryHeap{
+
+private:
+    std::vector<T> items;
+    Less less;
+
+    void siftUp(size_t i){
+        T item = std::move(items[i]);
+        while(i > 0){
+            size_t parent = (i - 1) / D;
+            if(!less(item, items[parent])) break;
+            items[i] = std::move(items[parent]);
+            i = parent;
+        }
+        items[i] = std::move(item);
+    }
+
+    void siftDown(size_t i){
+        const size_t n = items.size();
+        T item = std::move(items[i]);
+        for(;;){
+            size_t first = i * D + 1;
+            if(first >= n) break;
+            size_t last = first + D < n ? first + D : n;
+            size_t best = first;
+            for(size_t c = first + 1; c < last; ++c){
+                if(less(items[c], items[best])) best = c;
+            }
+            if(!less(items[best], item)) break;
+            items[i] = std::move(items[best]);
+            i = best;
+        }
+        items[i] = std::move(item);
+    }
+
+public:
+    explicit DaryHeap(Less less = Less()): less{less} {}
+
+    bool empty() const { return items.empty(); }
+    size_t size() const { return items.size(); }
+    void reserve(size_t n) { items.reserve(n); }
+    void clear() { items.clear(); }
+
+    const T& top() const { return items.front(); }
+
+    void push(const T& item){
+        items.push_back(item);
+        siftUp(items.size() - 1);
+    }
+
+    void pop(){
+        items.front() = std::move(items.back());
+        items.pop_back();
+        if(!items.empty()) siftDown(0);
+    }
+
+    // Substitui o topo (pop + push em uma única descida).
+    void replaceTop(const T& item){
+        items.front() = item;
+        siftDown(0);
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "world.h"
+#include "bvh.h"
+#include "dary_heap.h"
+#include <cstdint>
+#include <vector>
+
+// Simulação dirigida a eventos para particulas balísticas: entre colisões cada particula
+// anda em linha reta, então basta prever o instante do próximo contato (limite ou
+// segmento) e processá-la só nesse instante. As posições são avaliadas sob demanda
+// como p + v * (t - tLast). Em cenas esparsas o custo depende do número de colisões,
+// não do número de passos. As paredes sempre refletem (Boundary::Reflect), qualquer
+// que seja a política do World.
+class EventSimulation{
+
+private:
+    struct Event{
+        double time;
+        uint32_t particle;
+    };
+    struct EventLess{
+        bool operator()(const Event& a, const Event& b) const{
+            return a.time < b.time || (a.time == b.time && a.particle < b.particle);
+        }
+    };
+
+    // Tipo do próximo contato de cada particula.
+    static constexpr uint32_t WALL_X = 0xFFFFFFFEu;
+    static constexpr uint32_t WALL_Y = 0xFFFFFFFDu;
+
+    float xMin;
+    float xMax;
+    float yMin;
+    float yMax;
+
+    std::vector<ponto2D> segs;
+    SegmentTable table; // Cópia da tabela do World: normais já calculadas
+    SegmentBVH bvh;
+
+    // Estado de cada particula no instante tLast.
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> vx;
+    std::vector<double> vy;
+    std::vector<double> tLast;
+    std::vector<uint32_t> nextContact; // segmento, WALL_X ou WALL_Y
+    std::vector<uint32_t> lastSeg;     // último segmento atingido (ignorado na próxima previsão)
+
+    DaryHeap<Event, 4, EventLess> queue;
+    double now;
+    unsigned long events;
+
+    double predict(uint32_t i);
+    void process(uint32_t i, double t);
+
+public:
+    // Copia particulas, segmentos, limites e velocidade do World.
+    explicit EventSimulation(const World& world);
+
+    // Processa todos os eventos até o instante t e passa a valer now = t.
+    void advanceTo(double t);
+
+    double get_time() const { return now; }
+    unsigned long get_events() const { return events; }
+    size_t size() const { return x.size(); }
+
+    ponto2D positionAt(size_t i, double t) const;
+
+    // Posições no instante atual como floats intercalados (mesmo formato de World::writePositions).
+    void writePositions(float* dst) const;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "point.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Grade uniforme sobre [xMin,xMax]x[yMin,yMax] usada como broad-phase das colisões.
+// Cada célula lista (em formato CSR) os segmentos que a atravessam, então uma particula
+// só testa os segmentos das células tocadas pelo seu caminho em vez de todos.
+// Pontos fora do mundo são associados às células da borda.
+class SegmentGrid{
+
+private:
+    double xMin;
+    double yMin;
+    double cellW;
+    double cellH;
+    int cols;
+    int rows;
+    size_t maxCellCount; // Segmentos na célula mais cheia
+
+    std::vector<uint32_t> cellStart; // cols*rows + 1 offsets em cellItems
+    std::vector<uint32_t> cellItems; // índices de segmentos
+
+    int cellX(double x) const;
+    int cellY(double y) const;
+
+    // Chama f(cx, cy) para toda célula que o segmento ab atravessa (conservador).
+    template<typename F>
+    void rasterize(const ponto2D& a, const ponto2D& b, F&& f) const;
+
+public:
+    SegmentGrid();
+
+    // segs segue o formato do World: cada par (2i, 2i+1) é o segmento i.
+    // resolution <= 0 escolhe o número de células a partir da quantidade de segmentos.
+    void build(const std::vector<ponto2D>& segs, double xMin, double xMax, double yMin, double yMax, int resolution = 0);
+
+    // Preenche out com os índices (ordenados e sem repetição) dos segmentos
+    // que atravessam alguma célula da caixa [x0,x1]x[y0,y1].
+    void query(double x0, double y0, double x1, double y1, std::vector<uint32_t>& out) const;
+
+    int get_cols() const;
+    int get_rows() const;
+    // Maior número de segmentos em uma célula, para dimensionar o vetor de query.
+    size_t get_maxCellCount() const;
+    size_t get_itemCount() const;
+    size_t memoryBytes() const;
+};
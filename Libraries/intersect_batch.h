@@ -0,0 +1,24 @@
+#pragma once
+
+#include "point.h"
+#include <cstddef>
+#include <cstdint>
+
+// Versão em lote do teste de pointIntersectsSegment: para cada particula i testa o caminho
+// (x[i], y[i]) --> (x[i] + dx[i]*len, y[i] + dy[i]*len) contra o segmento ab e escreve
+// hits[i] = 1 se doIntersect seria verdadeiro (0 caso contrário).
+// As decisões são bit a bit iguais às de doIntersect em qualquer kernel.
+void intersectBatch(const double* x, const double* y, const double* dx, const double* dy, size_t n,
+                    double len, const ponto2D& a, const ponto2D& b, uint8_t* hits);
+
+// Kernels individuais; intersectBatch escolhe um deles uma única vez, conforme a CPU.
+void intersectBatchScalar(const double* x, const double* y, const double* dx, const double* dy, size_t n,
+                          double len, const ponto2D& a, const ponto2D& b, uint8_t* hits);
+void intersectBatchAvx2(const double* x, const double* y, const double* dx, const double* dy, size_t n,
+                        double len, const ponto2D& a, const ponto2D& b, uint8_t* hits);
+
+bool cpuHasAvx2();
+
+// Força o kernel escalar mesmo com AVX2 disponível (comparações e depuração).
+void forceScalarIntersectBatch(bool force);
+const char* intersectBatchKernelName();
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Fila circular limitada, sem locks, para vários produtores e vários consumidores
+// (algoritmo de D. Vyukov). Cada célula tem um número de sequência que diz se ela está
+// livre para a volta atual do produtor ou pronta para o consumidor; push e pop só fazem
+// um compare-exchange na posição compartilhada e nunca esperam: com a fila cheia
+// tryPush devolve false e o chamador decide o que fazer (ex.: contar o descarte).
+template<typename T>
+class MpmcRing{
+
+private:
+    struct Cell{
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    // Produtores e consumidores em linhas de cache separadas.
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+
+public:
+    // capacity é arredondada para cima até uma potência de 2 (mínimo 2).
+    explicit MpmcRing(size_t capacity){
+        size_t size = 2;
+        while(size < capacity){
+            size <<= 1;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for(size_t i = 0; i < size; ++i){
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    bool tryPush(const T& value){
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for(;;){
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0){
+                if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }else if(diff < 0){
+                return false; // cheia
+            }else{
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& out){
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for(;;){
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if(diff == 0){
+                if(dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                    out = cell.value;
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            }else if(diff < 0){
+                return false; // vazia
+            }else{
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    size_t capacity() const{ return mask + 1; }
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Referência estável a uma particula do World. Continua válida enquanto a particula se
+// move nos arrays (swapRemove, reordenação do hash) e deixa de valer quando ela sai, mesmo
+// que a entrada seja reaproveitada por outra: cada reuso troca a geração.
+struct ParticleHandle{
+    uint32_t index;      // Entrada na ParticleHandleTable
+    uint32_t generation;
+
+    bool operator==(const ParticleHandle& other) const{
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const ParticleHandle& other) const{
+        return !(*this == other);
+    }
+};
+
+// Tabela de indireção handle --> posição da particula nos arrays densos (slot).
+//
+// Cada entrada guarda a geração e o slot da particula viva; as entradas livres formam uma
+// lista encadeada pelo próprio campo do slot, então criar e remover são O(1) e a tabela só
+// cresce até o maior número de particulas vivas ao mesmo tempo. owners faz o caminho
+// inverso (slot --> entrada) e acompanha os arrays: swapRemove espelha o de
+// ParticleArrays, e quem reordena as particulas reordena owners junto e chama resync.
+//
+// Entradas novas começam em nextGeneration, maior que qualquer geração já usada, então
+// clear e assign não precisam visitar as entradas antigas para invalidar os handles delas.
+class ParticleHandleTable{
+
+private:
+    std::vector<uint32_t> slots;       // Por entrada: slot da particula, ou próxima entrada livre
+    std::vector<uint32_t> generations; // Por entrada: incrementada quando a particula sai
+    std::vector<uint32_t> owners;      // Por slot: entrada da particula que está nele
+    uint32_t freeHead;
+    uint32_t nextGeneration;
+
+    // Depois de assign(n), a entrada i é a particula do slot i com a geração lazyGeneration;
+    // os arrays só são montados (materialize) na primeira mudança.
+    bool lazy;
+    uint32_t lazyCount;
+    uint32_t lazyGeneration;
+
+    void materialize();
+    void retire(uint32_t index);
+
+public:
+    static constexpr uint32_t NO_SLOT = 0xFFFFFFFF;
+    static constexpr ParticleHandle INVALID{NO_SLOT, 0};
+
+    ParticleHandleTable();
+
+    // Com n reservado nos três arrays, nada aloca enquanto houver até n particulas vivas.
+    void reserve(size_t n);
+    // Invalida todos os handles existentes.
+    void clear();
+    // Handles novos para n particulas que já estão nos slots 0..n-1 (ex.: um snapshot
+    // restaurado no lugar), invalidando os anteriores. O(1): ver lazy.
+    void assign(size_t n);
+
+    // Handle da particula que acabou de entrar no fim dos arrays (slot size()).
+    ParticleHandle create();
+    // Espelha ParticleArrays::swapRemove(slot): o handle da particula removida deixa de
+    // valer e o da última passa a apontar para slot.
+    void swapRemove(uint32_t slot);
+
+    // Entrada de cada slot, para ser permutada junto com os arrays das particulas...
+    uint32_t* ownerData() { materialize(); return owners.data(); }
+    // ...e depois disso refazer o slot de cada entrada.
+    void resync();
+
+    // Slot atual da particula, ou NO_SLOT se o handle não vale mais. O(1).
+    uint32_t slotOf(ParticleHandle h) const{
+        if(lazy){
+            return h.index < lazyCount && h.generation == lazyGeneration ? h.index : NO_SLOT;
+        }
+        if(h.index >= generations.size() || generations[h.index] != h.generation){
+            return NO_SLOT;
+        }
+        return slots[h.index];
+    }
+    ParticleHandle handleAt(uint32_t slot) const{
+        if(lazy){
+            return ParticleHandle{slot, lazyGeneration};
+        }
+        uint32_t index = owners[slot];
+        return ParticleHandle{index, generations[index]};
+    }
+
+    size_t size() const { return lazy ? lazyCount : owners.size(); }      // Particulas vivas
+    size_t entryCount() const { return lazy ? lazyCount : slots.size(); } // Entradas (vivas e livres)
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+// Armazenamento Structure-of-Arrays das particulas: posições (x, y), direções (dx, dy) e
+// tempo de vida restante em arrays contíguos separados, cada um alinhado a 64 bytes
+// (linha de cache / AVX-512).
+// O array de vida só existe depois de enableLife (ou do primeiro push com vida finita):
+// enquanto todas as particulas são IMMORTAL, life() é nullptr e o passo só mexe nos
+// quatro arrays de posição e direção.
+// Substitui o antigo std::vector<std::pair<ponto2D, vec3>>, que carregava o z sempre nulo.
+//
+// As particulas vivas ficam sempre em [0, size()): swapRemove tapa o buraco com a última,
+// e [size(), capacity()) é o espaço livre para as próximas, sem realocar enquanto couber.
+class ParticleArrays{
+
+private:
+    double* xs;
+    double* ys;
+    double* dxs;
+    double* dys;
+    double* lifes;
+
+    size_t count;
+    size_t cap;
+
+    // Bloco único com x, y, dx e dy, e o bloco separado do array de vida.
+    std::shared_ptr<void> storage;
+    std::shared_ptr<void> lifeStorage;
+
+    void grow(size_t newCap);
+
+public:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t STREAMS = 4; // x, y, dx, dy; life fica à parte
+    // Tempo de vida de uma particula que nunca expira.
+    static constexpr double IMMORTAL = std::numeric_limits<double>::infinity();
+
+    ParticleArrays();
+    ParticleArrays(const ParticleArrays&) = delete;
+    ParticleArrays& operator=(const ParticleArrays&) = delete;
+    // A origem fica vazia (ponteiros nulos, size() e capacity() zerados).
+    ParticleArrays(ParticleArrays&& other) noexcept;
+    ParticleArrays& operator=(ParticleArrays&& other) noexcept;
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return count == 0; }
+
+    // Usa arrays que já estão na memória (ex.: um snapshot mapeado com mmap) sem copiar.
+    // storage mantém essa memória viva; cada array precisa de espaço para capacity doubles
+    // e alinhamento de ALIGNMENT. Crescer além de capacity copia para um bloco próprio.
+    // life pode ser nullptr (todas IMMORTAL).
+    static ParticleArrays adopt(std::shared_ptr<void> storage, double* x, double* y, double* dx, double* dy,
+                                double* life, size_t count, size_t capacity);
+
+    void reserve(size_t n);
+    // Cria o array de vida (IMMORTAL para as particulas atuais), se ainda não existe.
+    void enableLife();
+    void push(double x, double y, double dx, double dy, double life = IMMORTAL);
+    // Remove a particula i em O(1) movendo a última para o lugar dela (a ordem muda).
+    void swapRemove(size_t i){
+        --count;
+        xs[i] = xs[count];
+        ys[i] = ys[count];
+        dxs[i] = dxs[count];
+        dys[i] = dys[count];
+        if(lifes){
+            lifes[i] = lifes[count];
+        }
+    }
+    // Esvazia e descarta o array de vida.
+    void clear();
+
+    // Bytes lidos/escritos por particula em uma passada completa pelos arrays.
+    size_t bytesPerParticle() const { return (lifes ? STREAMS + 1 : STREAMS) * sizeof(double); }
+
+    double* x() { return xs; }
+    double* y() { return ys; }
+    double* dx() { return dxs; }
+    double* dy() { return dys; }
+    // Segundos simulados até expirar; IMMORTAL se não expira. nullptr sem enableLife.
+    double* life() { return lifes; }
+    const double* x() const { return xs; }
+    const double* y() const { return ys; }
+    const double* dx() const { return dxs; }
+    const double* dy() const { return dys; }
+    const double* life() const { return lifes; }
+};
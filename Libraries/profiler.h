@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Fases medidas pelo profiler. As de dentro do World rodam por bloco em cada worker,
+// então o valor delas é o tempo de CPU somado entre as threads do passo.
+enum class ProfilePhase : int{
+    Simulation,        // Todas as chamadas de World::step do frame (tempo de parede)
+    ParticleHash,      // Hash das particulas + escolha dos pares (com raio)
+    ParticleCollision, // Troca de velocidades entre particulas (com raio)
+    Move,              // moveParticles
+    Limits,            // intersectWithLimits
+    Segments,          // Colisão com segmentos (ou o avanço inteiro no modo Continuous)
+    Render,            // Envio das particulas e segmentos para a GPU
+    Swap,              // glfwSwapBuffers + glfwPollEvents
+    Frame,             // Frame completo: tempo entre duas chamadas de endFrame
+    COUNT
+};
+
+// Min/média/p99 em milissegundos sobre a janela de frames recentes.
+struct PhaseStats{
+    double minMs;
+    double avgMs;
+    double p99Ms;
+};
+
+// Acumula o tempo de cada fase dentro do frame atual (add pode ser chamado de qualquer
+// thread) e, a cada endFrame, guarda o frame em uma janela circular de WINDOW frames e,
+// se houver arquivo aberto, escreve uma linha de CSV.
+class FrameProfiler{
+
+private:
+    static constexpr int PHASES = static_cast<int>(ProfilePhase::COUNT);
+
+    std::atomic<uint64_t> current[PHASES];
+    std::vector<float> history; // WINDOW x PHASES, em ms
+    size_t frames;              // frames fechados desde o início
+    std::chrono::steady_clock::time_point lastEnd; // último endFrame (início do frame atual)
+    std::FILE* csv;
+
+    FrameProfiler();
+
+public:
+    static constexpr size_t WINDOW = 240;
+
+    FrameProfiler(const FrameProfiler&) = delete;
+    FrameProfiler& operator=(const FrameProfiler&) = delete;
+    ~FrameProfiler();
+
+    static FrameProfiler& instance();
+    static const char* phaseName(ProfilePhase phase);
+
+    void add(ProfilePhase phase, uint64_t ns){
+        current[static_cast<int>(phase)].fetch_add(ns, std::memory_order_relaxed);
+    }
+    void endFrame();
+
+    PhaseStats stats(ProfilePhase phase) const;
+    size_t get_frames() const;
+
+    // Uma linha por frame: frame, e o tempo (ms) de cada fase na ordem de ProfilePhase.
+    bool openCsv(const char* path);
+    void closeCsv();
+};
+
+// Mede o escopo em que foi criado e soma na fase ao ser destruído.
+class ScopedTimer{
+
+private:
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(ProfilePhase phase): phase{phase}, start{std::chrono::steady_clock::now()} {}
+    ~ScopedTimer(){
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        FrameProfiler::instance().add(phase, static_cast<uint64_t>(ns));
+    }
+};
+
+// Os timers só existem quando compilado com -DPARTICLE_PROFILE (make ... PROFILE=1);
+// sem a flag as macros não geram código nenhum.
+#ifdef PARTICLE_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__){phase}
+#define PROFILE_END_FRAME() FrameProfiler::instance().endFrame()
+#else
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "world.h"
+#include "profiler.h"
+#include "../glad/include/glad/glad.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include <vector>
+
+// Buffer de streaming para dados que mudam todo frame (posições das particulas).
+// Com ARB_buffer_storage: um único buffer mapeado de forma persistente e coerente,
+// dividido em REGIONS regiões usadas em rodízio, cada uma protegida por um fence;
+// o chamador escreve direto na memória mapeada, sem cópia intermediária.
+// Sem a extensão: orfanamento (glBufferData(nullptr) + glMapBufferRange a cada frame).
+class StreamBuffer{
+
+private:
+    unsigned int buffer;
+    size_t regionBytes;
+    int region;                 // região do frame atual
+    bool persistent;            // ARB_buffer_storage disponível
+    void* mapped;               // início do buffer mapeado (modo persistente)
+    GLsync fences[3];
+
+    void (APIENTRYP bufferStorage)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+    void allocate(size_t bytes);
+    void waitFence(int r);
+    void waitAll();
+
+public:
+    static const int REGIONS = 3;
+
+    StreamBuffer();
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // loader busca glBufferStorage (o glad deste projeto foi gerado para GL 4.3, sem a extensão).
+    void init(GLADloadproc loader);
+    void release();
+
+    // Devolve memória para escrever bytes neste frame. Pode recriar o buffer se bytes
+    // não couber na região, então o VAO deve apontar para id() a cada frame.
+    void* map(size_t bytes);
+    // Termina a escrita; devolve o offset (em bytes) da região escrita dentro de id().
+    size_t unmap();
+    // Chamado depois do draw que lê a região atual: protege a região e avança o rodízio.
+    void fence();
+
+    unsigned int id() const { return buffer; }
+    bool isPersistent() const { return persistent; }
+};
+
+// Desenha todas as particulas com uma única chamada glDrawArrays(GL_POINTS) por frame.
+// Os objetos de GL são criados uma vez; só o conteúdo dos buffers muda entre frames.
+// Usa um programa cujo vertex shader recebe posição 2D (location 0) e cor (location 1).
+class ParticleRenderer{
+
+private:
+    unsigned int vao;
+    StreamBuffer positionStream; // float x, y por particula, escrito pelo World todo frame
+    unsigned int colorVBO;       // float r, g, b por particula, enviado inteiro só quando cresce
+    size_t colorCapacity;
+
+    void ensureColorCapacity(size_t n);
+
+public:
+    ParticleRenderer();
+    ParticleRenderer(const ParticleRenderer&) = delete;
+    ParticleRenderer& operator=(const ParticleRenderer&) = delete;
+
+    // init e release precisam de um contexto OpenGL ativo (release antes do glfwTerminate).
+    void init(GLADloadproc loader);
+    void release();
+    void draw(const World& world, unsigned int shaderProgram, const glm::mat4& projection);
+
+    bool isPersistent() const { return positionStream.isPersistent(); }
+};
+
+// Segmentos e suas extremidades em um buffer de GPU que só é refeito quando
+// World::getSegsRevision() muda; desenhados com duas chamadas (GL_LINES e GL_POINTS).
+// Usa o programa de cor uniforme (posição em location 0, uniform color).
+class SegmentRenderer{
+
+private:
+    unsigned int vao;
+    unsigned int vbo;
+    size_t capacity;          // pontos que cabem no buffer atual
+    size_t pointCount;        // pontos enviados
+    unsigned long revision;   // revisão de segs enviada
+    bool uploaded;
+
+    std::vector<float> vertices;
+
+    void upload(const World& world);
+
+public:
+    SegmentRenderer();
+    SegmentRenderer(const SegmentRenderer&) = delete;
+    SegmentRenderer& operator=(const SegmentRenderer&) = delete;
+
+    // init e release precisam de um contexto OpenGL ativo (release antes do glfwTerminate).
+    void init();
+    void release();
+    void draw(const World& world, unsigned int shaderProgram, const glm::mat4& projection, float red, float green, float blue);
+};
+
+// HUD do profiler: uma barra por fase no canto superior esquerdo, com comprimento
+// proporcional ao tempo médio na janela do FrameProfiler (a largura cheia é budgetMs)
+// e um traço na posição do p99. Desenhada em coordenadas de tela (NDC) com o programa
+// de cor uniforme; o texto com os números vai no título da janela.
+class ProfilerOverlay{
+
+private:
+    unsigned int vao;
+    unsigned int vbo;
+    std::vector<float> vertices;
+
+public:
+    ProfilerOverlay();
+    ProfilerOverlay(const ProfilerOverlay&) = delete;
+    ProfilerOverlay& operator=(const ProfilerOverlay&) = delete;
+
+    // init e release precisam de um contexto OpenGL ativo (release antes do glfwTerminate).
+    void init();
+    void release();
+    void draw(const FrameProfiler& profiler, unsigned int shaderProgram, double budgetMs);
+};
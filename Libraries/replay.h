@@ -0,0 +1,132 @@
+#pragma once
+
+#include "world.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Gravação e reprodução determinística de uma simulação.
+//
+// O World publica no SimulationRecorder cada comando que muda o estado (ponto de
+// segmento, segmentos aleatórios, particula, limpeza, mudanças de configuração) com o
+// número do passo em que aconteceu; o número aleatório vem do gerador com semente do
+// World, e o passo é o mesmo com qualquer número de threads, então repetir os comandos
+// nos mesmos passos reproduz a simulação bit a bit. A cada hashInterval passos o
+// gravador guarda World::stateHash() para a reprodução conferir.
+//
+// Formato (valores nativos little-endian):
+//   "PPRP", uint32 versão, uint64 semente, float xMin, xMax, yMin, yMax, double dt,
+//   uint32 hashInterval
+//   estado inicial: float speed, uint8 broadPhase, uint8 collisionMode, uint8 boundary
+//   (desde a versão 2), double radius, double particleLifetime e uint64 particleCapacity
+//   (desde a versão 3),
+//   uint64 pontos de segmento + (double x, y) cada, uint64 particulas + (double x, y, dx, dy)
+//   cada, mais double life na versão 3; na versão 3 ainda uint64 emissores + (double x, y,
+//   rate, lifetime, pending) cada e uint64 segmentos absorventes + varint id cada
+//   registros: uint8 ReplayOp, varint (LEB128) passos desde o registro anterior, dados do op
+//   último registro: ReplayOp::End, com o total de passos gravados.
+enum class ReplayOp : uint8_t{
+    AddSegmentPoint = 1, // double x, y
+    RandomSegs,          // varint count
+    AddParticle,         // double x, y (direção sorteada pelo World)
+    AddParticleDir,      // double x, y, dx, dy
+    Reset,               // -
+    SetSpeed,            // float
+    SetBroadPhase,       // uint8
+    SetCollisionMode,    // uint8
+    SetRadius,           // double
+    StateHash,           // uint64
+    End,                 // -
+    LoadSegments,        // varint pontos, (double x, y) cada
+    SetBoundary,         // uint8
+    SetCapacity,         // varint
+    SetLifetime,         // double
+    AddEmitter,          // double x, y, rate, lifetime, pending
+    SetAbsorbing         // varint segmento, uint8
+};
+
+class SimulationRecorder{
+
+private:
+    std::FILE* file;
+    unsigned long lastTick;
+    unsigned hashInterval;
+    double dt;
+
+    void op(ReplayOp op, unsigned long tick);
+    void writeVarint(uint64_t v);
+    void writeEmitter(const Emitter& e);
+    template<typename T>
+    void writeRaw(const T& v){ std::fwrite(&v, sizeof(T), 1, file); }
+
+public:
+    static constexpr uint32_t FORMAT_VERSION = 3; // Lê também as versões 1 e 2
+
+    SimulationRecorder();
+    SimulationRecorder(const SimulationRecorder&) = delete;
+    SimulationRecorder& operator=(const SimulationRecorder&) = delete;
+    ~SimulationRecorder();
+
+    // Cria o arquivo, troca a semente do World por seed, grava o estado atual dele e
+    // se registra em world.setRecorder. dt é o dt de cada World::step da gravação.
+    bool begin(const char* path, World& world, uint64_t seed, double dt, unsigned hashInterval = 60);
+    // Grava o End, desliga o World e fecha o arquivo.
+    void finish(World& world);
+
+    unsigned get_hashInterval() const { return hashInterval; }
+    double get_dt() const { return dt; }
+
+    // Chamados pelo World.
+    void addSegmentPoint(unsigned long tick, const ponto2D& p);
+    void randomSegs(unsigned long tick, int count);
+    void loadSegments(unsigned long tick, const std::vector<ponto2D>& points);
+    void addParticle(unsigned long tick, const ponto2D& p);
+    void addParticle(unsigned long tick, const ponto2D& p, const vec2& dir);
+    void reset(unsigned long tick);
+    void setSpeed(unsigned long tick, float speed);
+    void setBroadPhase(unsigned long tick, BroadPhase bp);
+    void setCollisionMode(unsigned long tick, CollisionMode mode);
+    void setBoundary(unsigned long tick, Boundary boundary);
+    void setRadius(unsigned long tick, double radius);
+    void setParticleCapacity(unsigned long tick, size_t capacity);
+    void setParticleLifetime(unsigned long tick, double seconds);
+    void addEmitter(unsigned long tick, const Emitter& emitter);
+    void setSegmentAbsorbing(unsigned long tick, uint32_t seg, bool absorbing);
+    void stateHash(unsigned long tick, uint64_t hash);
+};
+
+struct ReplayResult{
+    unsigned long steps;          // passos executados
+    unsigned long hashesChecked;
+    unsigned long firstMismatch;  // passo do primeiro hash diferente (se ok == false)
+    bool ok;
+};
+
+// Lê uma gravação inteira para a memória e a executa em um World próprio.
+class SimulationReplay{
+
+private:
+    std::vector<uint8_t> data;
+    size_t commandsOffset; // Início dos registros
+    std::unique_ptr<World> world;
+    double dt;
+    unsigned hashInterval;
+    uint64_t seed;
+
+public:
+    SimulationReplay();
+
+    // false (com a mensagem em error) se o arquivo não existe ou não é uma gravação válida.
+    bool load(const char* path, std::string& error);
+
+    // Reexecuta tudo o mais rápido possível, conferindo cada hash gravado.
+    // stopOnMismatch: para no primeiro hash diferente.
+    ReplayResult run(bool stopOnMismatch = true);
+
+    World& getWorld() { return *world; }
+    double get_dt() const { return dt; }
+    unsigned get_hashInterval() const { return hashInterval; }
+    uint64_t get_seed() const { return seed; }
+};
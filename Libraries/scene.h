@@ -0,0 +1,63 @@
+#pragma once
+
+#include "point.h"
+#include "vec.h"
+#include "segment_table.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Segmentos de uma cena em arrays paralelos: points tem os dois extremos de cada
+// segmento (o mesmo formato de World::getSegs), normals e boxes um item por segmento.
+struct SceneSegments{
+    std::vector<ponto2D> points;
+    std::vector<vec2> normals;   // segmentNormal(a, b); World::loadSegments usa sem recalcular
+    std::vector<SegmentBox> boxes;
+
+    size_t size() const { return normals.size(); }
+    void reserve(size_t segments);
+    void clear();
+    // Acrescenta o segmento ab, calculando a normal e a caixa.
+    void add(const ponto2D& a, const ponto2D& b);
+};
+
+// Cabeçalho do formato binário de cena; os arrays vêm depois, cada um alinhado a 64 bytes,
+// exatamente como estão em SceneSegments (ordem de bytes da máquina).
+struct SceneFileHeader{
+    char magic[4];          // "PPSC"
+    uint32_t version;
+    uint32_t headerBytes;   // sizeof(SceneFileHeader)
+    uint32_t endianTag;     // 0x01020304
+    uint64_t segmentCount;
+    uint64_t pointsOffset;  // 2 * segmentCount ponto2D
+    uint64_t normalsOffset; // segmentCount vec2
+    uint64_t boxesOffset;   // segmentCount SegmentBox
+    uint64_t fileBytes;
+};
+
+// Carrega e grava cenas com muitos segmentos.
+//
+// Texto (para escrever à mão): um segmento por linha, "x0 y0 x1 y1"; linhas vazias e o
+// que vier depois de '#' são ignorados. Normais e caixas são calculadas na leitura.
+// Binário (para produção): SceneFileHeader seguido dos arrays prontos, lido com mmap e
+// copiado direto para SceneSegments, sem conversão. O arquivo é confiável por contrato
+// (gerado por saveBinary / --scene-export): o cabeçalho e os tamanhos são conferidos, mas
+// normais e caixas não são recalculadas, e valores adulterados só dão colisões erradas
+// (nenhum é usado como índice).
+// Nos dois casos o tempo de leitura é linear no tamanho do arquivo.
+class SceneLoader{
+
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    // Escolhe o formato pelo início do arquivo ("PPSC" --> binário, senão texto).
+    static bool load(const char* path, SceneSegments& scene, std::string& error);
+    static bool loadText(const char* path, SceneSegments& scene, std::string& error);
+    static bool loadBinary(const char* path, SceneSegments& scene, std::string& error);
+
+    static bool saveText(const SceneSegments& scene, const char* path, std::string& error);
+    static bool saveBinary(const SceneSegments& scene, const char* path, std::string& error);
+
+    // Segmentos completos (pares de pontos) de uma lista como World::getSegs.
+    static SceneSegments fromPoints(const std::vector<ponto2D>& points);
+};
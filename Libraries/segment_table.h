@@ -0,0 +1,71 @@
+#pragma once
+
+#include "point.h"
+#include "vec.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Caixa alinhada aos eixos que contém um segmento.
+struct SegmentBox{
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+};
+
+inline SegmentBox segmentBox(const ponto2D& a, const ponto2D& b){
+    return SegmentBox{std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)};
+}
+
+// Tudo o que o passo precisa de um segmento, calculado uma vez quando ele é criado.
+struct SegmentEntry{
+    ponto2D a;
+    ponto2D b;
+    vec2 normal;    // segmentNormal(a, b), unitária
+    SegmentBox box;
+    // Equação implícita da reta: lineA * (x - b.x) + lineB * (y - b.y) = 0, com
+    // lineA = b.y - a.y e lineB = a.x - b.x. side(p) é bit a bit o valor que
+    // orientation(a, b, p) calcula, então os testes que a usam dão as mesmas respostas.
+    double lineA;
+    double lineB;
+
+    double side(const ponto2D& p) const{
+        return lineA * (p.x - b.x) + lineB * (p.y - b.y);
+    }
+};
+
+// Segmentos do World em ordem: o id de um segmento é o índice dele aqui (o mesmo do par
+// de pontos 2*id, 2*id + 1 em World::getSegs e o que os CollisionEvent informam).
+// Segmentos absorventes removem a particula que os atinge em vez de refleti-la; a marca
+// fica em um array à parte, fora das entradas que o laço de colisão percorre.
+class SegmentTable{
+
+private:
+    std::vector<SegmentEntry> entries;
+    std::vector<uint8_t> absorbing; // Um por entrada
+
+public:
+    static SegmentEntry makeEntry(const ponto2D& a, const ponto2D& b);
+    // Com normal e caixa já conhecidas (ex.: de uma cena binária).
+    static SegmentEntry makeEntry(const ponto2D& a, const ponto2D& b, const vec2& normal, const SegmentBox& box);
+
+    void clear() { entries.clear(); absorbing.clear(); }
+    void reserve(size_t n) { entries.reserve(n); absorbing.reserve(n); }
+    void add(const ponto2D& a, const ponto2D& b) { add(makeEntry(a, b)); }
+    void add(const SegmentEntry& e) { entries.push_back(e); absorbing.push_back(0); }
+    // Refaz a tabela a partir de uma lista de pontos (pares consecutivos; um ponto
+    // sobrando no fim ainda não é segmento). As marcas de absorção dos ids que continuam
+    // existindo são mantidas.
+    void rebuild(const std::vector<ponto2D>& points);
+
+    bool absorbs(size_t id) const { return absorbing[id] != 0; }
+    void setAbsorbing(size_t id, bool absorbs) { absorbing[id] = absorbs ? 1 : 0; }
+    const uint8_t* absorbingFlags() const { return absorbing.data(); }
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    const SegmentEntry& operator[](size_t id) const { return entries[id]; }
+    const SegmentEntry* data() const { return entries.data(); }
+};
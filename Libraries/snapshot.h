@@ -0,0 +1,67 @@
+#pragma once
+
+#include "world.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Cabeçalho fixo no início de um snapshot. Todos os campos têm tamanho fixo e o arquivo
+// usa a ordem de bytes da máquina (endianTag confere isso na leitura).
+struct SnapshotHeader{
+    char magic[4];           // "PPSN"
+    uint32_t version;
+    uint32_t headerBytes;    // sizeof(SnapshotHeader)
+    uint32_t endianTag;      // 0x01020304
+
+    float xMin;
+    float xMax;
+    float yMin;
+    float yMax;
+    float speed;
+    uint8_t broadPhase;
+    uint8_t collisionMode;
+    uint8_t boundary;        // 0 (Reflect) em snapshots anteriores à política de limites
+    uint8_t padding;
+
+    double radius;
+    double time;
+    double particleLifetime;  // World::getParticleLifetime
+    uint64_t particleCapacity; // World::getParticleCapacity
+    uint64_t stepCount;
+    uint64_t seed;
+
+    uint64_t particleCount;
+    uint64_t particleStride;  // Bytes de cada array (x, y, dx, dy e life), múltiplo de ALIGNMENT
+    uint64_t particlesOffset; // Início de x; os outros arrays vêm a cada particleStride bytes
+    uint64_t segPointCount;
+    uint64_t segsOffset;      // Pontos de segmento como pares de double (x, y)
+    uint64_t emitterCount;
+    uint64_t emittersOffset;  // Emitter como está na memória
+    uint64_t absorbingOffset; // Um byte por segmento completo (SegmentTable::absorbs)
+    uint64_t rngOffset;       // Estado do gerador em texto (operator<< do mt19937_64)
+    uint64_t rngBytes;
+    uint64_t fileBytes;
+};
+
+// Snapshot binário do estado completo de um World: particulas, segmentos, parâmetros,
+// tempo, contador de passos e gerador aleatório.
+//
+// Layout: SnapshotHeader, zeros até particlesOffset (múltiplo do tamanho de página), os
+// arrays de particulas no mesmo formato de ParticleArrays (life só se existir: sem ele,
+// segsOffset vem logo depois de dy e todas são IMMORTAL), os segmentos, os emissores, as
+// marcas de absorção e o estado do gerador. save escreve tudo com um único writev sequencial (em um arquivo temporário
+// renomeado no fim); load mapeia o arquivo com mmap (MAP_PRIVATE) e o World passa a usar
+// os arrays mapeados no lugar, sem ler nem converter nada: o kernel traz as páginas sob
+// demanda e as escritas do passo ficam só na memória do processo.
+class WorldSnapshot{
+
+public:
+    static constexpr uint32_t FORMAT_VERSION = 2; // A versão 1 (sem tempo de vida nem emissores) ainda é lida
+
+    // false (com a mensagem em error) se o arquivo não pôde ser escrito.
+    static bool save(const World& world, const char* path, std::string& error);
+
+    // World novo com o estado do snapshot; nullptr (com a mensagem em error) se o arquivo
+    // não existe ou não é um snapshot válido.
+    static std::unique_ptr<World> load(const char* path, std::string& error);
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hash espacial das particulas, refeito a cada passo com counting sort. A chave é a
+// célula de uma grade uniforme sobre os limites do mundo (coordenadas fora deles vão
+// para a borda), então células vizinhas na mesma linha ficam contíguas na ordenação.
+// O build também reordena as particulas por célula: depois dele, o índice de uma
+// particula é a sua posição no hash, e a vizinhança 3x3 vira três faixas contíguas
+// de memória. As cópias internas guardam o estado do início do passo.
+class ParticleHash{
+
+private:
+    double xMin;
+    double yMin;
+    double cellSize;
+    int64_t cols;
+    int64_t rows;
+    std::vector<uint32_t> cellStart; // cols*rows + 1 offsets
+    std::vector<uint32_t> keys;      // célula de cada particula (temporário do build)
+    std::vector<double> hx;
+    std::vector<double> hy;
+    std::vector<double> hdx;
+    std::vector<double> hdy;
+    std::vector<double> hlife;
+    std::vector<uint32_t> hids;
+
+    int64_t cellX(double x) const{
+        return std::min(std::max(static_cast<int64_t>(std::floor((x - xMin) / cellSize)), int64_t{0}), cols - 1);
+    }
+    int64_t cellY(double y) const{
+        return std::min(std::max(static_cast<int64_t>(std::floor((y - yMin) / cellSize)), int64_t{0}), rows - 1);
+    }
+
+public:
+    ParticleHash();
+
+    // Reserva os buffers do build para até n particulas nesses limites (qualquer
+    // minCellSize): com isso o build não aloca enquanto o número de particulas não passar de n.
+    void reserve(size_t n, double xMin, double xMax, double yMin, double yMax);
+
+    // Ordena as n particulas por célula (os arrays são reescritos na nova ordem; life pode
+    // ser nullptr quando todos os tempos de vida são iguais e a ordem deles não importa).
+    // ids (ex.: ParticleHandleTable::ownerData), se não for nullptr, é permutado junto.
+    // minCellSize deve ser >= distância de interação, para bastar a vizinhança 3x3; a
+    // célula pode sair maior para que a grade não tenha muito mais células que particulas.
+    void build(double* x, double* y, double* dx, double* dy, double* life, uint32_t* ids, size_t n,
+               double minCellSize, double xMin, double xMax, double yMin, double yMax);
+
+    // Chama f(j, xj, yj, dxj, dyj) para cada particula j das 3x3 células em torno de
+    // (px, py), com os valores do momento do build.
+    template<typename F>
+    void forEachNeighbor(double px, double py, F&& f) const{
+        int64_t cx = cellX(px);
+        int64_t cy = cellY(py);
+        int64_t x0 = std::max(cx - 1, int64_t{0});
+        int64_t x1 = std::min(cx + 1, cols - 1);
+        int64_t y0 = std::max(cy - 1, int64_t{0});
+        int64_t y1 = std::min(cy + 1, rows - 1);
+        for(int64_t row = y0; row <= y1; ++row){
+            uint32_t begin = cellStart[row * cols + x0];
+            uint32_t end = cellStart[row * cols + x1 + 1];
+            for(uint32_t j = begin; j < end; ++j){
+                f(j, hx[j], hy[j], hdx[j], hdy[j]);
+            }
+        }
+    }
+
+    // Estado da particula j no momento do build.
+    double get_x(uint32_t j) const{ return hx[j]; }
+    double get_y(uint32_t j) const{ return hy[j]; }
+    double get_dx(uint32_t j) const{ return hdx[j]; }
+    double get_dy(uint32_t j) const{ return hdy[j]; }
+
+    size_t cellCount() const{ return static_cast<size_t>(cols * rows); }
+    double get_cellSize() const{ return cellSize; }
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads persistente: as threads são criadas uma vez e ficam esperando
+// o próximo parallelFor, sem custo de criação por passo da simulação.
+class ThreadPool{
+
+private:
+    typedef void (*ChunkFn)(void* ctx, size_t begin, size_t end, unsigned worker);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // Trabalho atual (válido enquanto generation não muda).
+    ChunkFn fn;
+    void* ctx;
+    size_t total;
+    size_t chunk;
+    std::atomic<size_t> nextChunk;
+    unsigned busy;
+    unsigned long generation;
+    bool stopping;
+
+    void workerLoop(unsigned worker);
+    void runChunks(unsigned worker);
+    void run(size_t n, size_t chunk, ChunkFn fn, void* ctx);
+
+public:
+    // threads conta a thread que chama parallelFor; 0 usa hardware_concurrency.
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const;
+
+    // Divide [0, n) em blocos de chunk itens e chama f(begin, end, worker) para cada bloco,
+    // com worker em [0, size()). Retorna quando todos os blocos terminaram.
+    template<typename F>
+    void parallelFor(size_t n, size_t chunk, F& f){
+        run(n, chunk, [](void* c, size_t begin, size_t end, unsigned worker){
+            (*static_cast<F*>(c))(begin, end, worker);
+        }, &f);
+    }
+};
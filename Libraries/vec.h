@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+// Vetor de N componentes só com cabeçalho: todas as operações são inline (e constexpr
+// quando não dependem de sqrt), então o compilador as elimina nos laços do passo.
+// vec3 (vectors.h) é o vec<double, 3> com a interface antiga; as contas da simulação,
+// que não têm z, usam vec2.
+template<typename T, size_t N>
+struct vec{
+    T v[N];
+
+    constexpr T& operator[](size_t i){ return v[i]; }
+    constexpr const T& operator[](size_t i) const{ return v[i]; }
+
+    constexpr vec operator+(const vec& o) const{
+        vec r{};
+        for(size_t i = 0; i < N; ++i) r.v[i] = v[i] + o.v[i];
+        return r;
+    }
+    constexpr vec operator-(const vec& o) const{
+        vec r{};
+        for(size_t i = 0; i < N; ++i) r.v[i] = v[i] - o.v[i];
+        return r;
+    }
+    constexpr vec operator*(T s) const{
+        vec r{};
+        for(size_t i = 0; i < N; ++i) r.v[i] = v[i] * s;
+        return r;
+    }
+    constexpr vec operator-() const{
+        return *this * T(-1);
+    }
+    constexpr T dot(const vec& o) const{
+        T sum{};
+        for(size_t i = 0; i < N; ++i) sum += v[i] * o.v[i];
+        return sum;
+    }
+    constexpr T norm2() const{ return dot(*this); }
+    T norm() const{ return std::sqrt(norm2()); }
+    vec normalized() const{ return *this * (T(1) / norm()); }
+};
+
+// Especialização 2D com membros x e y (sem a componente z que vec3 carrega sempre).
+template<typename T>
+struct vec<T, 2>{
+    T x;
+    T y;
+
+    constexpr vec(): x{}, y{} {}
+    constexpr vec(T x, T y): x{x}, y{y} {}
+
+    constexpr T& operator[](size_t i){ return i == 0 ? x : y; }
+    constexpr const T& operator[](size_t i) const{ return i == 0 ? x : y; }
+
+    constexpr vec operator+(const vec& o) const{ return vec{x + o.x, y + o.y}; }
+    constexpr vec operator-(const vec& o) const{ return vec{x - o.x, y - o.y}; }
+    constexpr vec operator*(T s) const{ return vec{x * s, y * s}; }
+    constexpr vec operator-() const{ return vec{-x, -y}; }
+
+    constexpr T dot(const vec& o) const{ return x * o.x + y * o.y; }
+    // Componente z do produto vetorial dos dois vetores no plano.
+    constexpr T cross(const vec& o) const{ return x * o.y - y * o.x; }
+    // Vetor perpendicular (rotação de -90 graus).
+    constexpr vec perp() const{ return vec{y, -x}; }
+    constexpr T norm2() const{ return x * x + y * y; }
+    T norm() const{ return std::sqrt(norm2()); }
+    vec normalized() const{
+        T d = norm();
+        return vec{x / d, y / d};
+    }
+
+    // Reflete em relação a uma normal unitária: v - 2 (v . n) n.
+    constexpr vec reflect(const vec& normal) const{
+        T d = dot(normal);
+        return vec{x - 2 * d * normal.x, y - 2 * d * normal.y};
+    }
+};
+
+template<typename T, size_t N>
+constexpr vec<T, N> operator*(T s, const vec<T, N>& v){
+    return v * s;
+}
+
+using vec2 = vec<double, 2>;
@@ -1,38 +1,68 @@
 #pragma once
 
+#include "vec.h"
 #include <iostream>
-#include <math.h>
 #include <cmath>
 
 
-class vec3{
-
-private:
-    double x;
-    double y;
-    double z;
+// vec3 é o vec<double, 3> de vec.h com a interface antiga (get_x, norma, reflect('z')...);
+// como o resto de vec.h, tudo é inline e as contas simples são constexpr.
+class vec3 : public vec<double, 3>{
 
 public:
 
-    vec3(double x, double y, double z);
+    constexpr vec3(double x, double y, double z): vec<double, 3>{{x, y, z}} {}
+    constexpr vec3(const vec<double, 3>& v): vec<double, 3>(v) {}
+
+    constexpr double get_x() const { return v[0]; }
+    constexpr double get_y() const { return v[1]; }
+    constexpr double get_z() const { return v[2]; }
+    double norma() const { return norm(); }
+
+    constexpr vec3 operator+(const vec3& o) const { return vec<double, 3>::operator+(o); }
+    constexpr vec3 operator-(const vec3& o) const { return vec<double, 3>::operator-(o); }
+    constexpr vec3 operator*(const double& s) const { return vec<double, 3>::operator*(s); }
 
-    double get_x() const;
-    double get_y() const;
-    double get_z() const;
-    double norma() const;
+    constexpr vec3 inverse() const { return *this * -1.0; }
+    constexpr double dot(const vec3& o) const { return vec<double, 3>::dot(o); }
+    // Cálculo via Determinante.
+    constexpr vec3 cross(const vec3& o) const{
+        return vec3(v[1] * o.v[2] - v[2] * o.v[1],
+                    v[2] * o.v[0] - v[0] * o.v[2],
+                    v[0] * o.v[1] - v[1] * o.v[0]);
+    }
 
-    vec3 operator+(const vec3& v) const;
-    vec3 operator-(const vec3& v) const;
-    vec3 operator*(const double& s) const;
+    // projeção do vetor atual (this) em o
+    constexpr vec3 projection(const vec3& o) const { return o * (dot(o) / o.dot(o)); }
 
-    vec3 inverse() const;
-    double dot(const vec3& v) const;
-    vec3 cross(const vec3& v) const;
+    /* Reflexão relativa a um eixo: 'z' preserva x e y e inverte z (reflexão no plano xy),
+       'x' e 'y' invertem a coordenada correspondente.
 
-    vec3 projection(const vec3& v) const; // projeção do vetor em v
-    vec3 reflect(const char& c) const;
+       |1 0 0 |   |x|    |x |
+       |0 1 0 | . |y| =  |y |   MATRIZ DE TRANSFORMAÇÃO -> reflect_z
+       |0 0 -1|   |z|    |-z|
+    */
+    vec3 reflect(const char& c) const{
+        if(c == 'z'){
+            return vec3(v[0], v[1], -v[2]);
+        }else if(c == 'x'){
+            return vec3(-v[0], v[1], v[2]);
+        }else if(c == 'y'){
+            return vec3(v[0], -v[1], v[2]);
+        }
+        std::cout << "Reflexão inválida" << std::endl;
+        return vec3(0.0, 0.0, 0.0);
+    }
 
-    void normalize();
+    // Divide pela norma no plano xy (o z das direções é sempre nulo), como antes.
+    void normalize(){
+        double d = std::sqrt(v[0] * v[0] + v[1] * v[1]);
+        v[0] /= d;
+        v[1] /= d;
+        v[2] /= d;
+    }
 };
 
-std::ostream& operator<<(std::ostream& os, const vec3& v);
\ No newline at end of file
+inline std::ostream& operator<<(std::ostream& os, const vec3& v){
+    return os << "vec3(" << v.get_x() << ", " << v.get_y() << ", " << v.get_z() << ")";
+}
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "point.h"
+#include "vec.h"
+#include "particles.h"
+#include "particle_handles.h"
+#include "grid.h"
+#include "bvh.h"
+#include "threadpool.h"
+#include "spatial_hash.h"
+#include "segment_table.h"
+#include "boundary.h"
+#include "collision_log.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+class SimulationRecorder;
+struct SceneSegments;
+
+// Como encontrar os segmentos candidatos à colisão com cada particula.
+enum class BroadPhase{
+    Linear, // Testa todos os segmentos (O(particulas x segmentos))
+    Grid,   // Grade uniforme de segmentos (SegmentGrid)
+    Bvh     // Hierarquia de caixas (SegmentBVH); reflete só no contato mais próximo
+};
+
+// Como o movimento de um passo é resolvido contra segmentos e limites.
+enum class CollisionMode{
+    Discrete,   // Move, depois testa o caminho do próximo passo e só inverte a direção
+    Continuous  // CCD: avança até o primeiro contato, reflete e continua com o tempo restante
+};
+
+// Conferem um byte lido de arquivo (snapshot, gravação) antes de convertê-lo no enum.
+inline bool validBroadPhase(uint8_t v){ return v <= static_cast<uint8_t>(BroadPhase::Bvh); }
+inline bool validCollisionMode(uint8_t v){ return v <= static_cast<uint8_t>(CollisionMode::Continuous); }
+
+// Buffers temporários de cada worker do passo (um por thread, para não haver disputa).
+struct StepScratch{
+    std::vector<uint32_t> candidates; // Resultado das consultas à grade
+    std::vector<uint8_t> hitMask;     // Resultado de intersectBatch por particula do bloco
+    std::vector<uint32_t> partners;   // Vizinha escolhida por particula do bloco
+    // Menor e maior índice das particulas que saem do World no fim do passo (nenhuma
+    // enquanto expiredFirst > expiredLast).
+    size_t expiredFirst = SIZE_MAX;
+    size_t expiredLast = 0;
+};
+
+// Fonte contínua de particulas: rate particulas por segundo simulado nascem em position,
+// com direção sorteada pelo gerador do World e tempo de vida lifetime.
+struct Emitter{
+    ponto2D position;
+    double rate = 0.0;
+    double lifetime = ParticleArrays::IMMORTAL;
+    double pending = 0.0; // Fração de particula acumulada entre passos
+};
+
+// Contadores do pool de particulas desde a construção do World.
+struct ParticlePoolStats{
+    uint64_t spawned = 0;   // Criadas (addParticle, emissores, reset)
+    uint64_t despawned = 0; // Removidas por tempo de vida ou por segmento absorvente
+    uint64_t dropped = 0;   // Não criadas porque o pool estava cheio
+};
+
+// Estado completo da simulação, independente de janela/OpenGL.
+// Pode ser avançado tanto pelo loop do GLFW quanto por um executável headless.
+class World{
+
+private:
+    // Limites do Plano Cartesiano 2D
+    float xMin;
+    float xMax;
+    float yMin;
+    float yMax;
+
+    float speed; // Deslocamento por segundo simulado
+
+    // Pontos clicados/gerados; cada par consecutivo (i, i+1) forma um segmento.
+    std::vector<ponto2D> segs;
+    SegmentTable segTable; // Um item por par completo de segs, na mesma ordem
+    ParticleArrays particles;
+    ParticleHandleTable handles; // Um handle por particula, acompanhando swapRemove e o hash
+
+    BroadPhase broadPhase;
+    CollisionMode collisionMode;
+    Boundary boundary;
+    void (World::*limitsFn)(size_t, size_t); // applyLimits<Policy> da política atual
+    SegmentGrid grid;
+    SegmentBVH bvh;
+    bool accelDirty; // segs mudou desde a última construção da grade/BVH
+    unsigned long segsRevision; // incrementa a cada mudança em segs
+
+    double radius; // Raio das particulas; 0 --> não colidem entre si
+    ParticleHash particleHash; // Refeito a cada passo quando radius > 0
+
+    // Pool de particulas: com capacidade fixa, nada é realocado durante a simulação e o
+    // que não couber é descartado; as removidas saem com swapRemove no fim do passo.
+    size_t particleCapacity;   // 0 --> cresce conforme a necessidade
+    double particleLifetime;   // Tempo de vida das criadas por addParticle
+    std::vector<Emitter> emitters;
+    bool despawning;           // Alguma particula pode sair (vida finita ou segmento absorvente)
+    ParticlePoolStats poolStats;
+
+    double time; // Tempo simulado desde o último reset
+    CollisionLog* collisionLog; // nullptr --> colisões não são publicadas
+
+    uint64_t seed;           // Semente de rng (randomDirection, randomSegs)
+    std::mt19937_64 rng;
+    unsigned long stepCount; // Chamadas de step desde a construção (não volta a 0 no reset)
+    SimulationRecorder* recorder; // nullptr --> nada é gravado
+
+    std::unique_ptr<ThreadPool> pool; // nullptr --> passo na thread que chama
+    std::vector<StepScratch> scratch; // Um por worker do pool
+
+    vec2 randomDirection();
+    ParticleHandle pushParticle(const ponto2D& p, const vec2& dir, double life);
+    void emitParticles(double dt);
+    void removeExpired();
+    void reserveScratch();
+
+    // As funções do passo atuam sobre o intervalo [begin, end) das particulas;
+    // stepRange junta todas em uma única passada sobre um bloco.
+    bool pointIntersectsSegment(const ponto2D& point, double dx, double dy, const SegmentEntry& seg, double dt) const;
+    void checkIntersect(uint32_t seg, size_t begin, size_t end, double dt, StepScratch& s);
+    void checkIntersectGrid(size_t begin, size_t end, double dt, StepScratch& s);
+    void checkIntersectBvh(size_t begin, size_t end, double dt);
+    void rebuildAccel();
+    void publishCollision(size_t particle, uint32_t seg, double time, double x, double y, const vec2& normal){
+        if(collisionLog){
+            const uint32_t slot = static_cast<uint32_t>(particle);
+            collisionLog->publish(CollisionEvent{handles.handleAt(slot), seg, slot, time, x, y, normal.x, normal.y});
+        }
+    }
+    template<typename Policy>
+    void applyLimits(size_t begin, size_t end);
+    void intersectWithLimits(size_t begin, size_t end);
+    void moveParticles(size_t begin, size_t end, double dt);
+    uint32_t choosePartner(uint32_t i) const;
+    void collideParticles(size_t begin, size_t end, StepScratch& s);
+    uint32_t nearestSegmentHit(const ponto2D& p, const ponto2D& q, double& t, uint32_t exclude, StepScratch& s) const;
+    void advanceContinuous(size_t begin, size_t end, double dt, StepScratch& s);
+    void ageParticles(size_t begin, size_t end, double dt, StepScratch& s);
+    void stepRange(size_t begin, size_t end, double dt, StepScratch& s);
+
+public:
+
+    World(float xMin, float xMax, float yMin, float yMax, float speed);
+
+    // Avança a simulação em dt segundos (normalmente o dt fixo de um SimulationClock):
+    // emissores, colisão entre particulas (se houver raio), movimento, colisão com os
+    // limites e com os segmentos, e por fim a remoção das particulas que expiraram.
+    void step(double dt);
+
+    // Particulas por bloco do passo: cabe no cache durante o laço de segmentos.
+    static constexpr size_t STEP_CHUNK = 4096;
+
+    // Número de threads do passo (contando a que chama step); 0 usa todos os núcleos.
+    void setThreadCount(unsigned threads);
+    unsigned getThreadCount() const;
+
+    // Contatos resolvidos por particula em um passo no modo Continuous; o que sobrar
+    // do caminho depois disso é descartado (evita laço infinito em cantos).
+    static constexpr int MAX_BOUNCES = 16;
+
+    static constexpr uint32_t NO_PARTNER = 0xFFFFFFFF;
+
+    // Raio das particulas para colisões elásticas entre elas (massas iguais).
+    // Por passo, cada particula colide no máximo com uma vizinha; os demais contatos
+    // ficam para os passos seguintes.
+    // Com raio > 0, dx/dy passam a ser a velocidade em unidades de speed: o módulo
+    // muda nas trocas de momento. 0 desliga (padrão). Com raio, cada passo reordena as
+    // particulas por célula do hash, então o índice de uma particula não é estável.
+    void setParticleRadius(double radius);
+    double getParticleRadius() const;
+
+    // Cada colisão com segmento vira um CollisionEvent publicado em log (sem bloquear o
+    // passo); nullptr desliga. O log não pertence ao World e precisa viver mais que ele.
+    void setCollisionLog(CollisionLog* log);
+    CollisionLog* getCollisionLog() const;
+
+    void setCollisionMode(CollisionMode mode);
+    CollisionMode getCollisionMode() const;
+
+    // Política dos limites do mundo (ver boundary.h); vale nos dois modos de colisão.
+    void setBoundary(Boundary b);
+    Boundary getBoundary() const;
+
+    void setBroadPhase(BroadPhase bp);
+    BroadPhase getBroadPhase() const;
+    const SegmentGrid& getGrid() const;
+    const SegmentBVH& getBvh() const;
+
+    void addSegmentPoint(const ponto2D& p);
+    void randomSegs(int count = 4); // Gera count segmentos de retas aleatórios
+    // Acrescenta todos os segmentos de uma cena de uma vez (ver scene.h).
+    void loadSegments(const SceneSegments& scene);
+    // Devolvem o handle da particula criada (ParticleHandleTable::INVALID com o pool cheio).
+    ParticleHandle addParticle(const ponto2D& p, const vec2& dir); // dir é normalizada aqui
+    ParticleHandle addParticle(const ponto2D& p); // Nasce com sentido aleatório
+
+    // Índice atual em getParticles() da particula de h, ou ParticleHandleTable::NO_SLOT se
+    // ela já saiu do World. O(1); vale até o próximo passo ou comando que mude as particulas.
+    uint32_t findParticle(ParticleHandle h) const;
+    // Handle da particula que está no índice i de getParticles().
+    ParticleHandle particleHandle(size_t i) const;
+
+    // Capacidade fixa do pool de particulas: reserva o espaço agora e, depois, criar além
+    // dele não faz nada (conta em ParticlePoolStats::dropped). 0 volta a crescer à vontade.
+    // Remover não muda a ordem das demais exceto pela última, que ocupa o lugar da removida;
+    // como com raio, o índice de uma particula não é estável entre passos (o handle é).
+    void setParticleCapacity(size_t capacity);
+    size_t getParticleCapacity() const;
+    // Tempo de vida (segundos simulados) das particulas criadas depois por addParticle;
+    // <= 0 ou ParticleArrays::IMMORTAL --> não expiram (padrão).
+    void setParticleLifetime(double seconds);
+    double getParticleLifetime() const;
+    // Emissores valem até o próximo reset.
+    void addEmitter(const Emitter& emitter);
+    const std::vector<Emitter>& getEmitters() const;
+    // Particula que atinge um segmento absorvente sai do World no fim do passo.
+    void setSegmentAbsorbing(uint32_t seg, bool absorbing);
+    const ParticlePoolStats& getPoolStats() const;
+
+    // Limpa segmentos, particulas e emissores e recria a particula principal na origem.
+    void reset();
+
+    // Substitui segmentos, particulas e tempo de uma vez (reprodução, snapshots); não é
+    // gravado como comando. Os segmentos novos não absorvem, as particulas recebem handles
+    // novos, e particles é usado como está, sem reservar a capacidade do pool.
+    void restore(const std::vector<ponto2D>& segs, ParticleArrays&& particles, double time);
+
+    // Toda aleatoriedade do World vem de um gerador com esta semente (por padrão, de
+    // std::random_device): com a mesma semente e os mesmos comandos nos mesmos passos,
+    // a simulação se repete bit a bit.
+    void setSeed(uint64_t seed);
+    uint64_t get_seed() const;
+    unsigned long get_stepCount() const;
+
+    // Os comandos que mudam o estado (addSegmentPoint, randomSegs, addParticle, addEmitter,
+    // reset e os set* de configuração) são enviados ao gravador; nullptr desliga (ver replay.h).
+    void setRecorder(SimulationRecorder* recorder);
+    SimulationRecorder* getRecorder() const;
+
+    // Hash das particulas e segmentos, usado para conferir reproduções.
+    uint64_t stateHash() const;
+
+    float get_xMin() const;
+    float get_xMax() const;
+    float get_yMin() const;
+    float get_yMax() const;
+    float get_speed() const;
+    double get_time() const; // Tempo simulado desde o último reset
+    void setSpeed(float speed);
+
+    const std::vector<ponto2D>& getSegs() const;
+    // Segmentos com normal, caixa e reta pré-calculadas; o id de cada um é o dos CollisionEvent.
+    const SegmentTable& getSegmentTable() const;
+    // Muda sempre que segs muda (cliques, randomSegs, reset): quem guarda uma cópia
+    // dos segmentos (ex.: o buffer de GPU) só precisa refazê-la quando o valor mudar.
+    unsigned long getSegsRevision() const;
+    const ParticleArrays& getParticles() const;
+
+    // Copia as posições como floats intercalados (x0, y0, x1, y1, ...) para o renderizador.
+    // dst precisa ter espaço para 2 * getParticles().size() floats.
+    void writePositions(float* dst) const;
+    // Mesmo formato para os pontos de getSegs() (o renderizador de segmentos);
+    // dst precisa ter espaço para 2 * getSegs().size() floats.
+    void writeSegmentVertices(float* dst) const;
+
+    // bench.cpp mede as fases privadas do passo isoladamente.
+    friend class WorldBench;
+    // O snapshot grava e restaura também o gerador e o contador de passos.
+    friend class WorldSnapshot;
+};
@@ -0,0 +1,70 @@
+#include "../Libraries/alloc_count.h"
+
+#ifdef PARTICLE_COUNT_ALLOCS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> allocCount{0};
+static std::atomic<uint64_t> allocBytes{0};
+
+static void* countedAlloc(std::size_t size, std::size_t alignment){
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if(size == 0){
+        size = 1;
+    }
+    if(alignment <= alignof(std::max_align_t)){
+        return std::malloc(size);
+    }
+    // aligned_alloc exige tamanho múltiplo do alinhamento.
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void* countedAllocOrThrow(std::size_t size, std::size_t alignment){
+    void* p = countedAlloc(size, alignment);
+    if(!p){
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(std::size_t size){ return countedAllocOrThrow(size, 0); }
+void* operator new[](std::size_t size){ return countedAllocOrThrow(size, 0); }
+void* operator new(std::size_t size, std::align_val_t al){ return countedAllocOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al){ return countedAllocOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept{ return countedAlloc(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept{ return countedAlloc(size, 0); }
+
+void operator delete(void* p) noexcept{ std::free(p); }
+void operator delete[](void* p) noexcept{ std::free(p); }
+void operator delete(void* p, std::size_t) noexcept{ std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept{ std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept{ std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept{ std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept{ std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept{ std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept{ std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept{ std::free(p); }
+
+bool allocationCountingEnabled(){
+    return true;
+}
+
+AllocStats allocationStats(){
+    return AllocStats{allocCount.load(std::memory_order_relaxed), allocBytes.load(std::memory_order_relaxed)};
+}
+
+#else
+
+bool allocationCountingEnabled(){
+    return false;
+}
+
+AllocStats allocationStats(){
+    return AllocStats{0, 0};
+}
+
+#endif
@@ -0,0 +1,236 @@
+#include "../Libraries/bvh.h"
+#include "../Libraries/collision.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+const int SAH_BINS = 16;
+
+struct Box{
+    double minX = std::numeric_limits<double>::infinity();
+    double minY = std::numeric_limits<double>::infinity();
+    double maxX = -std::numeric_limits<double>::infinity();
+    double maxY = -std::numeric_limits<double>::infinity();
+
+    void grow(double x, double y){
+        minX = std::min(minX, x); minY = std::min(minY, y);
+        maxX = std::max(maxX, x); maxY = std::max(maxY, y);
+    }
+    void grow(const Box& b){
+        minX = std::min(minX, b.minX); minY = std::min(minY, b.minY);
+        maxX = std::max(maxX, b.maxX); maxY = std::max(maxY, b.maxY);
+    }
+    // Em 2D a "área de superfície" da SAH vira o perímetro da caixa.
+    double perimeter() const{
+        if(minX > maxX) return 0.0;
+        return 2.0 * ((maxX - minX) + (maxY - minY));
+    }
+};
+
+Box segmentBox(const std::vector<ponto2D>& segs, uint32_t id){
+    Box b;
+    b.grow(segs[2 * id].x, segs[2 * id].y);
+    b.grow(segs[2 * id + 1].x, segs[2 * id + 1].y);
+    return b;
+}
+
+// Teste de slab do caminho p + t*d (t em [0, tMax]) contra a caixa do nó.
+// Devolve em tEntry o t de entrada na caixa.
+bool hitsBox(const BVHNode& n, double px, double py, double dx, double dy, double tMax, double& tEntry){
+    const double eps = 1e-9;
+    double t0 = 0.0, t1 = tMax;
+
+    if(dx != 0.0){
+        double ta = (n.minX - px) / dx, tb = (n.maxX - px) / dx;
+        if(ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta); t1 = std::min(t1, tb);
+    }else if(px < n.minX - eps || px > n.maxX + eps){
+        return false;
+    }
+
+    if(dy != 0.0){
+        double ta = (n.minY - py) / dy, tb = (n.maxY - py) / dy;
+        if(ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta); t1 = std::min(t1, tb);
+    }else if(py < n.minY - eps || py > n.maxY + eps){
+        return false;
+    }
+
+    tEntry = t0;
+    return t0 <= t1 + eps;
+}
+
+}
+
+void SegmentBVH::subdivide(uint32_t index, std::vector<uint32_t>& ids, std::vector<double>& cx, std::vector<double>& cy,
+                           const std::vector<ponto2D>& segs, size_t begin, size_t end, int depth){
+    Box bounds, centroids;
+    for(size_t i = begin; i < end; ++i){
+        bounds.grow(segmentBox(segs, ids[i]));
+        centroids.grow(cx[ids[i]], cy[ids[i]]);
+    }
+    nodes[index].minX = bounds.minX; nodes[index].minY = bounds.minY;
+    nodes[index].maxX = bounds.maxX; nodes[index].maxY = bounds.maxY;
+
+    size_t count = end - begin;
+    auto makeLeaf = [&](){
+        nodes[index].first = static_cast<uint32_t>(begin);
+        nodes[index].count = static_cast<uint32_t>(count);
+    };
+    // O limite de profundidade garante que a pilha fixa de nearestHit não estoure.
+    if(count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH){
+        makeLeaf();
+        return;
+    }
+
+    // SAH com bins sobre os centróides, nos dois eixos.
+    double bestCost = std::numeric_limits<double>::infinity();
+    int bestAxis = -1, bestSplit = 0;
+    for(int axis = 0; axis < 2; ++axis){
+        double lo = axis == 0 ? centroids.minX : centroids.minY;
+        double hi = axis == 0 ? centroids.maxX : centroids.maxY;
+        if(hi <= lo) continue;
+
+        Box binBox[SAH_BINS];
+        size_t binCount[SAH_BINS] = {};
+        double scale = SAH_BINS / (hi - lo);
+        for(size_t i = begin; i < end; ++i){
+            double c = axis == 0 ? cx[ids[i]] : cy[ids[i]];
+            int b = std::min(SAH_BINS - 1, static_cast<int>((c - lo) * scale));
+            binBox[b].grow(segmentBox(segs, ids[i]));
+            ++binCount[b];
+        }
+
+        // Varredura da direita para a esquerda guardando o custo do lado direito.
+        double rightCost[SAH_BINS];
+        Box acc; size_t accCount = 0;
+        for(int b = SAH_BINS - 1; b > 0; --b){
+            acc.grow(binBox[b]); accCount += binCount[b];
+            rightCost[b] = accCount * acc.perimeter();
+        }
+        acc = Box(); accCount = 0;
+        for(int b = 0; b < SAH_BINS - 1; ++b){
+            acc.grow(binBox[b]); accCount += binCount[b];
+            double cost = accCount * acc.perimeter() + rightCost[b + 1];
+            if(accCount > 0 && accCount < count && cost < bestCost){
+                bestCost = cost; bestAxis = axis; bestSplit = b;
+            }
+        }
+    }
+
+    // Centróides todos iguais ou dividir não compensa: vira folha.
+    if(bestAxis < 0 || (bestCost >= count * bounds.perimeter() && count <= 4 * MAX_LEAF_SIZE)){
+        makeLeaf();
+        return;
+    }
+
+    double lo = bestAxis == 0 ? centroids.minX : centroids.minY;
+    double hi = bestAxis == 0 ? centroids.maxX : centroids.maxY;
+    double scale = SAH_BINS / (hi - lo);
+    auto mid = std::partition(ids.begin() + begin, ids.begin() + end, [&](uint32_t id){
+        double c = bestAxis == 0 ? cx[id] : cy[id];
+        return std::min(SAH_BINS - 1, static_cast<int>((c - lo) * scale)) <= bestSplit;
+    });
+    size_t split = static_cast<size_t>(mid - ids.begin());
+
+    // Os dois filhos ficam lado a lado no array.
+    uint32_t left = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[index].first = left;
+    nodes[index].count = 0;
+
+    subdivide(left, ids, cx, cy, segs, begin, split, depth + 1);
+    subdivide(left + 1, ids, cx, cy, segs, split, end, depth + 1);
+}
+
+void SegmentBVH::build(const std::vector<ponto2D>& segs){
+    nodes.clear();
+    leafSegs.clear();
+    leafIds.clear();
+
+    size_t segCount = segs.size() / 2;
+    if(segCount == 0){
+        return;
+    }
+
+    std::vector<uint32_t> ids(segCount);
+    std::vector<double> cx(segCount), cy(segCount);
+    for(size_t s = 0; s < segCount; ++s){
+        ids[s] = static_cast<uint32_t>(s);
+        cx[s] = 0.5 * (segs[2 * s].x + segs[2 * s + 1].x);
+        cy[s] = 0.5 * (segs[2 * s].y + segs[2 * s + 1].y);
+    }
+
+    nodes.reserve(2 * segCount);
+    nodes.emplace_back();
+    subdivide(0, ids, cx, cy, segs, 0, segCount, 0);
+
+    // Copia os segmentos na ordem das folhas para a travessia ler memória contígua; a
+    // entrada completa traz lineA/lineB, como a SegmentTable usada pelos outros caminhos.
+    leafSegs.resize(segCount);
+    for(size_t i = 0; i < segCount; ++i){
+        leafSegs[i] = SegmentTable::makeEntry(segs[2 * ids[i]], segs[2 * ids[i] + 1]);
+    }
+    leafIds = std::move(ids);
+}
+
+uint32_t SegmentBVH::nearestHit(const ponto2D& p, const ponto2D& q, double& t, uint32_t exclude) const{
+    uint32_t best = NO_HIT;
+    double bestT = 1.0;
+    if(nodes.empty()){
+        return best;
+    }
+
+    const double dx = q.x - p.x, dy = q.y - p.y;
+    uint32_t stack[MAX_DEPTH + 2];
+    int top = 0;
+    stack[top++] = 0;
+
+    while(top > 0){
+        const BVHNode& node = nodes[stack[--top]];
+        double tEntry;
+        if(!hitsBox(node, p.x, p.y, dx, dy, bestT, tEntry)){
+            continue;
+        }
+
+        if(node.count > 0){
+            for(uint32_t i = node.first; i < node.first + node.count; ++i){
+                uint32_t id = leafIds[i];
+                if(id == exclude) continue;
+                const SegmentEntry& e = leafSegs[i];
+                if(segmentIntersect(p, q, e)){
+                    double th = intersectionTime(p, q, e.a, e.b);
+                    // Empate: menor índice, para o resultado não depender da forma da árvore.
+                    if(best == NO_HIT || th < bestT || (th == bestT && id < best)){
+                        best = id;
+                        bestT = th;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Visita primeiro o filho mais próximo (empilhado por último).
+        uint32_t left = node.first, right = node.first + 1;
+        double tl, tr;
+        bool hl = hitsBox(nodes[left], p.x, p.y, dx, dy, bestT, tl);
+        bool hr = hitsBox(nodes[right], p.x, p.y, dx, dy, bestT, tr);
+        if(hl && hr){
+            if(tl <= tr){ stack[top++] = right; stack[top++] = left; }
+            else        { stack[top++] = left;  stack[top++] = right; }
+        }else if(hl){
+            stack[top++] = left;
+        }else if(hr){
+            stack[top++] = right;
+        }
+    }
+
+    t = bestT;
+    return best;
+}
+
+size_t SegmentBVH::memoryBytes() const{
+    return nodes.size() * sizeof(BVHNode) + leafSegs.size() * sizeof(SegmentEntry) + leafIds.size() * sizeof(uint32_t);
+}
@@ -0,0 +1,50 @@
+#include "../Libraries/clock.h"
+
+SimulationClock::SimulationClock(double dt, int substeps, int maxCatchUp):
+    dt{dt}, substeps{substeps < 1 ? 1 : substeps}, maxCatchUp{maxCatchUp < 1 ? 1 : maxCatchUp},
+    accumulator{0.0}, ticks{0}, droppedTime{0.0} {}
+
+int SimulationClock::advance(double frameSeconds){
+    if(frameSeconds > 0.0){
+        accumulator += frameSeconds;
+    }
+
+    int steps = static_cast<int>(accumulator / dt);
+    if(steps > maxCatchUp){
+        droppedTime += (steps - maxCatchUp) * dt;
+        accumulator -= (steps - maxCatchUp) * dt;
+        steps = maxCatchUp;
+    }
+    accumulator -= steps * dt;
+    ticks += steps;
+
+    return steps * substeps;
+}
+
+double SimulationClock::get_dt() const{
+    return this->dt;
+}
+
+double SimulationClock::get_stepDt() const{
+    return this->dt / this->substeps;
+}
+
+int SimulationClock::get_substeps() const{
+    return this->substeps;
+}
+
+unsigned long SimulationClock::get_ticks() const{
+    return this->ticks;
+}
+
+double SimulationClock::get_droppedTime() const{
+    return this->droppedTime;
+}
+
+double SimulationClock::get_time() const{
+    return this->ticks * this->dt;
+}
+
+double SimulationClock::alpha() const{
+    return this->accumulator / this->dt;
+}
@@ -0,0 +1,104 @@
+#include "../Libraries/collision.h"
+#include <algorithm>
+
+bool onSegment(const ponto2D& p, const ponto2D& q, const ponto2D& r) {
+    return q.x <= std::max(p.x, r.x) && q.x >= std::min(p.x, r.x) &&
+           q.y <= std::max(p.y, r.y) && q.y >= std::min(p.y, r.y);
+}
+
+// Mesma ideia usada em Triangulação de pontos.
+int orientation(const ponto2D& p, const ponto2D& q, const ponto2D& r) {
+    double val = (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
+    if (val == 0) return 0;
+    return (val > 0) ? 1 : 2;
+}
+
+// A ideia vai ser lidar com: a particula no frame atual, a particula do frame seguinte (projetada dado a dir),
+// o ponto a e o ponto b (Segmento de reta que pode gerar a colisão).
+bool doIntersect(const ponto2D& p1, const ponto2D& q1, const ponto2D& p2, const ponto2D& q2) {
+    int o1 = orientation(p1, q1, p2);
+    int o2 = orientation(p1, q1, q2);
+    int o3 = orientation(p2, q2, p1);
+    int o4 = orientation(p2, q2, q1);
+
+    if (o1 != o2 && o3 != o4) {return true;} // Caso Base: Retas que se cruzam com sentidos e angulos distintos.
+
+    //Exemplo:
+    /*
+
+                                a
+                                |
+                                |
+                                |    
+        ponto_neste_frame ------------- ponto_no_proximo_frame
+                                |
+                                |
+                                |
+                                b
+    */
+
+
+    // Caso Especial de Colinearidade
+    if (o1 == 0 && onSegment(p1, p2, q1)) {return true;}
+    if (o2 == 0 && onSegment(p1, q2, q1)) {return true;}
+    if (o3 == 0 && onSegment(p2, p1, q2)) {return true;}
+    if (o4 == 0 && onSegment(p2, q1, q2)) {return true;}
+
+    return false;
+}
+
+// Mesma sequência de doIntersect; o3/o4 e o teste colinear de p1/q1 sobre o segmento
+// vêm de side() e da caixa, sem recalcular b - a.
+bool segmentIntersect(const ponto2D& p1, const ponto2D& q1, const SegmentEntry& s){
+    int o1 = orientation(p1, q1, s.a);
+    int o2 = orientation(p1, q1, s.b);
+    double v3 = s.side(p1);
+    double v4 = s.side(q1);
+    int o3 = v3 == 0 ? 0 : (v3 > 0 ? 1 : 2);
+    int o4 = v4 == 0 ? 0 : (v4 > 0 ? 1 : 2);
+
+    if (o1 != o2 && o3 != o4) {return true;}
+
+    auto inBox = [&](const ponto2D& q){
+        return q.x <= s.box.maxX && q.x >= s.box.minX && q.y <= s.box.maxY && q.y >= s.box.minY;
+    };
+    if (o1 == 0 && onSegment(p1, s.a, q1)) {return true;}
+    if (o2 == 0 && onSegment(p1, s.b, q1)) {return true;}
+    if (o3 == 0 && inBox(p1)) {return true;}
+    if (o4 == 0 && inBox(q1)) {return true;}
+
+    return false;
+}
+
+vec3 calculateNormal(const ponto2D& a, const ponto2D& b){
+    vec3 normal{b.y - a.y, a.x - b.x, 0.0};
+    normal.normalize();
+    return normal;
+}
+
+vec3 reflect(const vec3& dir, const vec3& normal) {
+    double dotProduct = dir.dot(normal);
+    vec3 reflection{dir.get_x() - 2 * dotProduct * normal.get_x(), dir.get_y() - 2 * dotProduct * normal.get_y(), 0.0};
+    return reflection;
+}
+
+double intersectionTime(const ponto2D& p1, const ponto2D& q1, const ponto2D& p2, const ponto2D& q2){
+    double rx = q1.x - p1.x, ry = q1.y - p1.y;
+    double sx = q2.x - p2.x, sy = q2.y - p2.y;
+    double wx = p2.x - p1.x, wy = p2.y - p1.y;
+
+    double denom = rx * sy - ry * sx;
+    if(denom != 0.0){
+        double t = (wx * sy - wy * sx) / denom;
+        return std::min(std::max(t, 0.0), 1.0);
+    }
+
+    // Colineares: o contato é a primeira extremidade de p2q2 alcançada (ou o próprio p1).
+    double rr = rx * rx + ry * ry;
+    if(rr == 0.0 || onSegment(p2, p1, q2)){
+        return 0.0;
+    }
+    double t2 = (wx * rx + wy * ry) / rr;
+    double tq = ((q2.x - p1.x) * rx + (q2.y - p1.y) * ry) / rr;
+    return std::min(std::max(std::min(t2, tq), 0.0), 1.0);
+}
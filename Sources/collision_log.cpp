@@ -0,0 +1,96 @@
+#include "../Libraries/collision_log.h"
+#include <chrono>
+
+CollisionLog::CollisionLog(size_t capacity):
+    ring{capacity}, consumed{0}, dropped{0}, file{nullptr}, running{false} {}
+
+CollisionLog::~CollisionLog(){
+    stop();
+}
+
+bool CollisionLog::openFile(const char* path){
+    file = std::fopen(path, "wb");
+    if(!file){
+        return false;
+    }
+    const uint32_t header[] = {FORMAT_VERSION, static_cast<uint32_t>(sizeof(CollisionEvent))};
+    std::fwrite("PPCL", 1, 4, file);
+    std::fwrite(header, sizeof(uint32_t), 2, file);
+    batch.reserve(BATCH);
+    return true;
+}
+
+void CollisionLog::reserveSegments(size_t segmentCount){
+    if(segmentHits.size() < segmentCount){
+        segmentHits.resize(segmentCount, 0);
+    }
+}
+
+void CollisionLog::consume(const CollisionEvent& e){
+    if(e.segment >= segmentHits.size()){
+        segmentHits.resize(e.segment + 1, 0);
+    }
+    ++segmentHits[e.segment];
+    if(file){
+        batch.push_back(e);
+        if(batch.size() >= BATCH){
+            flushBatch();
+        }
+    }
+    consumed.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CollisionLog::flushBatch(){
+    if(file && !batch.empty()){
+        std::fwrite(batch.data(), sizeof(CollisionEvent), batch.size(), file);
+    }
+    batch.clear();
+}
+
+size_t CollisionLog::drain(){
+    size_t count = 0;
+    CollisionEvent e;
+    while(ring.tryPop(e)){
+        consume(e);
+        ++count;
+    }
+    flushBatch();
+    return count;
+}
+
+void CollisionLog::start(){
+    if(running.exchange(true)){
+        return;
+    }
+    consumer = std::thread([this]{
+        while(running.load(std::memory_order_acquire)){
+            // Fila vazia: dorme um pouco em vez de girar; os produtores não esperam por isso.
+            if(drain() == 0){
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    });
+}
+
+void CollisionLog::stop(){
+    if(running.exchange(false)){
+        consumer.join();
+    }
+    drain();
+    if(file){
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+uint64_t CollisionLog::get_consumed() const{
+    return consumed.load(std::memory_order_relaxed);
+}
+
+uint64_t CollisionLog::get_dropped() const{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+const std::vector<uint64_t>& CollisionLog::getSegmentHits() const{
+    return segmentHits;
+}
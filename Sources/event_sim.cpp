@@ -0,0 +1,127 @@
+#include "../Libraries/event_sim.h"
+#include "../Libraries/collision.h"
+#include <algorithm>
+#include <limits>
+
+EventSimulation::EventSimulation(const World& world):
+    xMin{world.get_xMin()}, xMax{world.get_xMax()}, yMin{world.get_yMin()}, yMax{world.get_yMax()},
+    segs(world.getSegs()), table(world.getSegmentTable()), now{0.0}, events{0} {
+    // Um ponto sem par (último clique) ainda não forma segmento.
+    if(segs.size() % 2 != 0){
+        segs.pop_back();
+    }
+    bvh.build(segs);
+
+    const ParticleArrays& particles = world.getParticles();
+    const size_t n = particles.size();
+    const double speed = world.get_speed();
+
+    x.assign(particles.x(), particles.x() + n);
+    y.assign(particles.y(), particles.y() + n);
+    vx.resize(n);
+    vy.resize(n);
+    for(size_t i = 0; i < n; ++i){
+        vx[i] = particles.dx()[i] * speed;
+        vy[i] = particles.dy()[i] * speed;
+    }
+    tLast.assign(n, 0.0);
+    nextContact.assign(n, 0);
+    lastSeg.assign(n, SegmentBVH::NO_HIT);
+
+    queue.reserve(n);
+    for(uint32_t i = 0; i < n; ++i){
+        double t = predict(i);
+        if(t < std::numeric_limits<double>::infinity()){
+            queue.push(Event{t, i});
+        }
+    }
+}
+
+// Instante do próximo contato da particula i a partir do seu estado em tLast[i].
+// Também guarda em nextContact[i] o que será atingido.
+double EventSimulation::predict(uint32_t i){
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // Limites: só a parede para a qual a particula se move.
+    double tx = inf, ty = inf;
+    if(vx[i] > 0.0) tx = (xMax - x[i]) / vx[i];
+    else if(vx[i] < 0.0) tx = (xMin - x[i]) / vx[i];
+    if(vy[i] > 0.0) ty = (yMax - y[i]) / vy[i];
+    else if(vy[i] < 0.0) ty = (yMin - y[i]) / vy[i];
+
+    double dt = std::max(std::min(tx, ty), 0.0);
+    if(dt == inf){
+        return inf; // parada
+    }
+    nextContact[i] = tx <= ty ? WALL_X : WALL_Y;
+
+    // Segmentos: o caminho até a parede limita a busca na BVH.
+    if(!bvh.empty() && dt > 0.0){
+        ponto2D p{x[i], y[i]};
+        ponto2D q{x[i] + vx[i] * dt, y[i] + vy[i] * dt};
+        double f;
+        uint32_t seg = bvh.nearestHit(p, q, f, lastSeg[i]);
+        if(seg != SegmentBVH::NO_HIT){
+            dt *= f;
+            nextContact[i] = seg;
+        }
+    }
+
+    return tLast[i] + dt;
+}
+
+void EventSimulation::process(uint32_t i, double t){
+    x[i] += vx[i] * (t - tLast[i]);
+    y[i] += vy[i] * (t - tLast[i]);
+    tLast[i] = t;
+
+    uint32_t contact = nextContact[i];
+    if(contact == WALL_X){
+        x[i] = vx[i] > 0.0 ? xMax : xMin;
+        vx[i] = -vx[i];
+        lastSeg[i] = SegmentBVH::NO_HIT;
+    }else if(contact == WALL_Y){
+        y[i] = vy[i] > 0.0 ? yMax : yMin;
+        vy[i] = -vy[i];
+        lastSeg[i] = SegmentBVH::NO_HIT;
+    }else{
+        const vec2& normal = table[contact].normal;
+        // Mantém o ponto de contato do lado de onde a particula veio.
+        double side = (vx[i] * normal.x + vy[i] * normal.y) > 0.0 ? -1.0 : 1.0;
+        x[i] += side * normal.x * 1e-9;
+        y[i] += side * normal.y * 1e-9;
+
+        vec2 newVelocity = reflect(vec2{vx[i], vy[i]}, normal);
+        vx[i] = newVelocity.x;
+        vy[i] = newVelocity.y;
+        lastSeg[i] = contact;
+    }
+    ++events;
+}
+
+void EventSimulation::advanceTo(double t){
+    while(!queue.empty() && queue.top().time <= t){
+        Event e = queue.top();
+        process(e.particle, e.time);
+
+        double next = predict(e.particle);
+        if(next < std::numeric_limits<double>::infinity()){
+            queue.replaceTop(Event{next, e.particle});
+        }else{
+            queue.pop();
+        }
+    }
+    now = std::max(now, t);
+}
+
+ponto2D EventSimulation::positionAt(size_t i, double t) const{
+    return ponto2D{x[i] + vx[i] * (t - tLast[i]), y[i] + vy[i] * (t - tLast[i])};
+}
+
+void EventSimulation::writePositions(float* dst) const{
+    const size_t n = x.size();
+    for(size_t i = 0; i < n; ++i){
+        dst[2 * i] = static_cast<float>(x[i] + vx[i] * (now - tLast[i]));
+        dst[2 * i + 1] = static_cast<float>(y[i] + vy[i] * (now - tLast[i]));
+    }
+}
@@ -0,0 +1,142 @@
+#include "../Libraries/grid.h"
+#include <algorithm>
+#include <cmath>
+
+SegmentGrid::SegmentGrid():
+    xMin{0.0}, yMin{0.0}, cellW{1.0}, cellH{1.0}, cols{0}, rows{0}, maxCellCount{0} {}
+
+int SegmentGrid::cellX(double x) const{
+    int c = static_cast<int>(std::floor((x - xMin) / cellW));
+    return std::min(std::max(c, 0), cols - 1);
+}
+
+int SegmentGrid::cellY(double y) const{
+    int c = static_cast<int>(std::floor((y - yMin) / cellH));
+    return std::min(std::max(c, 0), rows - 1);
+}
+
+// Percorre as linhas da grade que o segmento cobre e, em cada uma, o intervalo de colunas
+// ocupado pelo trecho do segmento dentro daquela faixa de y.
+template<typename F>
+void SegmentGrid::rasterize(const ponto2D& a, const ponto2D& b, F&& f) const{
+    const ponto2D& lo = (a.y <= b.y) ? a : b;
+    const ponto2D& hi = (a.y <= b.y) ? b : a;
+
+    int cy0 = cellY(lo.y);
+    int cy1 = cellY(hi.y);
+    double dy = hi.y - lo.y;
+
+    for(int cy = cy0; cy <= cy1; ++cy){
+        double xa, xb;
+        if(cy0 == cy1 || dy == 0.0){
+            xa = lo.x; xb = hi.x;
+        }else{
+            // Trecho do segmento entre as bordas inferior e superior da linha cy.
+            double rowLo = std::max(lo.y, yMin + cy * cellH);
+            double rowHi = std::min(hi.y, yMin + (cy + 1) * cellH);
+            if(cy == cy0) rowLo = lo.y;
+            if(cy == cy1) rowHi = hi.y;
+            xa = lo.x + (hi.x - lo.x) * ((rowLo - lo.y) / dy);
+            xb = lo.x + (hi.x - lo.x) * ((rowHi - lo.y) / dy);
+        }
+        // Margem de meia célula contra erros de arredondamento nas bordas.
+        double margin = 0.5 * cellW;
+        int cx0 = cellX(std::min(xa, xb) - margin);
+        int cx1 = cellX(std::max(xa, xb) + margin);
+        for(int cx = cx0; cx <= cx1; ++cx){
+            f(cx, cy);
+        }
+    }
+}
+
+void SegmentGrid::build(const std::vector<ponto2D>& segs, double xMin, double xMax, double yMin, double yMax, int resolution){
+    size_t segCount = segs.size() / 2;
+
+    if(resolution <= 0){
+        // ~2 células por segmento em cada eixo...
+        double r = std::sqrt(static_cast<double>(segCount)) * 2.0;
+
+        // ...mas segmentos longos aparecem em muitas células: com resolução r, o segmento
+        // entra em ~r * (|dx|/largura + |dy|/altura) células. Limita o total a ~32 por segmento.
+        double span = 0.0;
+        for(size_t s = 0; s < segCount; ++s){
+            span += std::abs(segs[2 * s + 1].x - segs[2 * s].x) / (xMax - xMin);
+            span += std::abs(segs[2 * s + 1].y - segs[2 * s].y) / (yMax - yMin);
+        }
+        if(span > 0.0){
+            r = std::min(r, 32.0 * segCount / span);
+        }
+        resolution = std::min(std::max(static_cast<int>(r), 1), 1024);
+    }
+
+    this->xMin = xMin;
+    this->yMin = yMin;
+    cols = resolution;
+    rows = resolution;
+    cellW = (xMax - xMin) / cols;
+    cellH = (yMax - yMin) / rows;
+
+    // Contagem, prefixo e preenchimento (counting sort por célula).
+    cellStart.assign(static_cast<size_t>(cols) * rows + 1, 0);
+    for(size_t s = 0; s < segCount; ++s){
+        rasterize(segs[2 * s], segs[2 * s + 1], [&](int cx, int cy){
+            ++cellStart[static_cast<size_t>(cy) * cols + cx + 1];
+        });
+    }
+    maxCellCount = *std::max_element(cellStart.begin(), cellStart.end());
+    for(size_t c = 1; c < cellStart.size(); ++c){
+        cellStart[c] += cellStart[c - 1];
+    }
+
+    cellItems.resize(cellStart.back());
+    std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+    for(size_t s = 0; s < segCount; ++s){
+        rasterize(segs[2 * s], segs[2 * s + 1], [&](int cx, int cy){
+            cellItems[fill[static_cast<size_t>(cy) * cols + cx]++] = static_cast<uint32_t>(s);
+        });
+    }
+}
+
+void SegmentGrid::query(double x0, double y0, double x1, double y1, std::vector<uint32_t>& out) const{
+    out.clear();
+    if(cols == 0){
+        return;
+    }
+
+    int cx0 = cellX(x0), cx1 = cellX(x1);
+    int cy0 = cellY(y0), cy1 = cellY(y1);
+
+    for(int cy = cy0; cy <= cy1; ++cy){
+        for(int cx = cx0; cx <= cx1; ++cx){
+            size_t c = static_cast<size_t>(cy) * cols + cx;
+            out.insert(out.end(), cellItems.begin() + cellStart[c], cellItems.begin() + cellStart[c + 1]);
+        }
+    }
+
+    // Um segmento pode aparecer em várias células; ordenar também preserva
+    // a ordem de teste da varredura linear (segmento 0, 1, 2...).
+    if(cx0 != cx1 || cy0 != cy1){
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+}
+
+int SegmentGrid::get_cols() const{
+    return this->cols;
+}
+
+int SegmentGrid::get_rows() const{
+    return this->rows;
+}
+
+size_t SegmentGrid::get_maxCellCount() const{
+    return this->maxCellCount;
+}
+
+size_t SegmentGrid::get_itemCount() const{
+    return this->cellItems.size();
+}
+
+size_t SegmentGrid::memoryBytes() const{
+    return (cellStart.size() + cellItems.size()) * sizeof(uint32_t);
+}
@@ -0,0 +1,88 @@
+// Compilado com -mavx2 -ffp-contract=off: sem FMA, cada operação arredonda igual ao código escalar.
+#include "../Libraries/intersect_batch.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace {
+
+// orientation() sem desvios: devolve as máscaras "val > 0" (1, horário) e "val == 0" (0, colinear).
+// O caso 2 (anti-horário) é o que sobra, exatamente como no escalar (inclusive para NaN).
+inline void orientationMask(__m256d px, __m256d py, __m256d qx, __m256d qy, __m256d rx, __m256d ry,
+                            __m256d& gt, __m256d& eq){
+    __m256d val = _mm256_sub_pd(_mm256_mul_pd(_mm256_sub_pd(qy, py), _mm256_sub_pd(rx, qx)),
+                                _mm256_mul_pd(_mm256_sub_pd(qx, px), _mm256_sub_pd(ry, qy)));
+    __m256d zero = _mm256_setzero_pd();
+    gt = _mm256_cmp_pd(val, zero, _CMP_GT_OQ);
+    eq = _mm256_cmp_pd(val, zero, _CMP_EQ_OQ);
+}
+
+// std::max(a, b) == (a < b) ? b : a, e std::min(a, b) == (b < a) ? b : a.
+inline __m256d stdMax(__m256d a, __m256d b){
+    return _mm256_blendv_pd(a, b, _mm256_cmp_pd(a, b, _CMP_LT_OQ));
+}
+
+inline __m256d stdMin(__m256d a, __m256d b){
+    return _mm256_blendv_pd(a, b, _mm256_cmp_pd(b, a, _CMP_LT_OQ));
+}
+
+// onSegment(p, q, r) com máscaras.
+inline __m256d onSegmentMask(__m256d px, __m256d py, __m256d qx, __m256d qy, __m256d rx, __m256d ry){
+    __m256d m = _mm256_and_pd(_mm256_cmp_pd(qx, stdMax(px, rx), _CMP_LE_OQ),
+                              _mm256_cmp_pd(qx, stdMin(px, rx), _CMP_GE_OQ));
+    m = _mm256_and_pd(m, _mm256_cmp_pd(qy, stdMax(py, ry), _CMP_LE_OQ));
+    return _mm256_and_pd(m, _mm256_cmp_pd(qy, stdMin(py, ry), _CMP_GE_OQ));
+}
+
+}
+
+void intersectBatchAvx2(const double* x, const double* y, const double* dx, const double* dy, size_t n,
+                        double len, const ponto2D& a, const ponto2D& b, uint8_t* hits){
+    const __m256d ax = _mm256_set1_pd(a.x), ay = _mm256_set1_pd(a.y);
+    const __m256d bx = _mm256_set1_pd(b.x), by = _mm256_set1_pd(b.y);
+    const __m256d l = _mm256_set1_pd(len);
+
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        __m256d px = _mm256_loadu_pd(x + i);
+        __m256d py = _mm256_loadu_pd(y + i);
+        __m256d qx = _mm256_add_pd(px, _mm256_mul_pd(_mm256_loadu_pd(dx + i), l));
+        __m256d qy = _mm256_add_pd(py, _mm256_mul_pd(_mm256_loadu_pd(dy + i), l));
+
+        __m256d gt1, eq1, gt2, eq2, gt3, eq3, gt4, eq4;
+        orientationMask(px, py, qx, qy, ax, ay, gt1, eq1);
+        orientationMask(px, py, qx, qy, bx, by, gt2, eq2);
+        orientationMask(ax, ay, bx, by, px, py, gt3, eq3);
+        orientationMask(ax, ay, bx, by, qx, qy, gt4, eq4);
+
+        // o1 != o2 && o3 != o4
+        __m256d diff12 = _mm256_or_pd(_mm256_xor_pd(gt1, gt2), _mm256_xor_pd(eq1, eq2));
+        __m256d diff34 = _mm256_or_pd(_mm256_xor_pd(gt3, gt4), _mm256_xor_pd(eq3, eq4));
+        __m256d hit = _mm256_and_pd(diff12, diff34);
+
+        // Casos especiais de colinearidade.
+        hit = _mm256_or_pd(hit, _mm256_and_pd(eq1, onSegmentMask(px, py, ax, ay, qx, qy)));
+        hit = _mm256_or_pd(hit, _mm256_and_pd(eq2, onSegmentMask(px, py, bx, by, qx, qy)));
+        hit = _mm256_or_pd(hit, _mm256_and_pd(eq3, onSegmentMask(ax, ay, px, py, bx, by)));
+        hit = _mm256_or_pd(hit, _mm256_and_pd(eq4, onSegmentMask(ax, ay, qx, qy, bx, by)));
+
+        int mask = _mm256_movemask_pd(hit);
+        hits[i] = mask & 1;
+        hits[i + 1] = (mask >> 1) & 1;
+        hits[i + 2] = (mask >> 2) & 1;
+        hits[i + 3] = (mask >> 3) & 1;
+    }
+
+    // Resto (n não múltiplo de 4).
+    intersectBatchScalar(x + i, y + i, dx + i, dy + i, n - i, len, a, b, hits + i);
+}
+
+#else
+
+// Sem suporte do compilador: o despacho nunca escolhe este kernel, mas o símbolo precisa existir.
+void intersectBatchAvx2(const double* x, const double* y, const double* dx, const double* dy, size_t n,
+                        double len, const ponto2D& a, const ponto2D& b, uint8_t* hits){
+    intersectBatchScalar(x, y, dx, dy, n, len, a, b, hits);
+}
+
+#endif
@@ -0,0 +1,41 @@
+#include "../Libraries/intersect_batch.h"
+#include "../Libraries/collision.h"
+
+void intersectBatchScalar(const double* x, const double* y, const double* dx, const double* dy, size_t n,
+                          double len, const ponto2D& a, const ponto2D& b, uint8_t* hits){
+    for(size_t i = 0; i < n; ++i){
+        ponto2D point{x[i], y[i]};
+        ponto2D projectedPoint{x[i] + dx[i] * len, y[i] + dy[i] * len};
+        hits[i] = doIntersect(point, projectedPoint, a, b) ? 1 : 0;
+    }
+}
+
+bool cpuHasAvx2(){
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+typedef void (*IntersectBatchFn)(const double*, const double*, const double*, const double*, size_t,
+                                 double, const ponto2D&, const ponto2D&, uint8_t*);
+
+static IntersectBatchFn selectKernel(bool forceScalar){
+    return (!forceScalar && cpuHasAvx2()) ? intersectBatchAvx2 : intersectBatchScalar;
+}
+
+static IntersectBatchFn kernel = selectKernel(false);
+
+void forceScalarIntersectBatch(bool force){
+    kernel = selectKernel(force);
+}
+
+const char* intersectBatchKernelName(){
+    return kernel == intersectBatchAvx2 ? "avx2" : "escalar";
+}
+
+void intersectBatch(const double* x, const double* y, const double* dx, const double* dy, size_t n,
+                    double len, const ponto2D& a, const ponto2D& b, uint8_t* hits){
+    kernel(x, y, dx, dy, n, len, a, b, hits);
+}
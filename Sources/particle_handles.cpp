@@ -0,0 +1,84 @@
+#include "../Libraries/particle_handles.h"
+#include <algorithm>
+
+ParticleHandleTable::ParticleHandleTable():
+    freeHead{NO_SLOT}, nextGeneration{0}, lazy{false}, lazyCount{0}, lazyGeneration{0} {}
+
+void ParticleHandleTable::reserve(size_t n){
+    slots.reserve(n);
+    generations.reserve(n);
+    owners.reserve(n);
+}
+
+void ParticleHandleTable::clear(){
+    // Entradas vivas podem estar em nextGeneration; as criadas depois começam acima dela.
+    ++nextGeneration;
+    lazy = false;
+    slots.clear();
+    generations.clear();
+    owners.clear();
+    freeHead = NO_SLOT;
+}
+
+void ParticleHandleTable::assign(size_t n){
+    clear();
+    lazy = true;
+    lazyCount = static_cast<uint32_t>(n);
+    lazyGeneration = nextGeneration++;
+}
+
+void ParticleHandleTable::materialize(){
+    if(!lazy){
+        return;
+    }
+    lazy = false;
+    slots.resize(lazyCount);
+    owners.resize(lazyCount);
+    for(uint32_t i = 0; i < lazyCount; ++i){
+        slots[i] = i;
+        owners[i] = i;
+    }
+    generations.assign(lazyCount, lazyGeneration);
+}
+
+// A entrada vai para a lista livre com uma geração nova.
+void ParticleHandleTable::retire(uint32_t index){
+    uint32_t generation = ++generations[index];
+    nextGeneration = std::max(nextGeneration, generation + 1);
+    slots[index] = freeHead;
+    freeHead = index;
+}
+
+ParticleHandle ParticleHandleTable::create(){
+    materialize();
+    const uint32_t slot = static_cast<uint32_t>(owners.size());
+    uint32_t index;
+    if(freeHead != NO_SLOT){
+        index = freeHead;
+        freeHead = slots[index];
+        slots[index] = slot;
+    }else{
+        index = static_cast<uint32_t>(slots.size());
+        slots.push_back(slot);
+        generations.push_back(nextGeneration);
+    }
+    owners.push_back(index);
+    return ParticleHandle{index, generations[index]};
+}
+
+void ParticleHandleTable::swapRemove(uint32_t slot){
+    materialize();
+    const uint32_t removed = owners[slot];
+    const uint32_t last = owners.back();
+    owners[slot] = last;
+    slots[last] = slot;
+    owners.pop_back();
+    retire(removed);
+}
+
+void ParticleHandleTable::resync(){
+    materialize();
+    for(size_t s = 0; s < owners.size(); ++s){
+        slots[owners[s]] = static_cast<uint32_t>(s);
+    }
+}
@@ -0,0 +1,124 @@
+#include "../Libraries/particles.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+// Tamanho de cada array arredondado para manter o próximo também alinhado.
+static size_t streamBytes(size_t cap){
+    size_t bytes = cap * sizeof(double);
+    return (bytes + ParticleArrays::ALIGNMENT - 1) / ParticleArrays::ALIGNMENT * ParticleArrays::ALIGNMENT;
+}
+
+ParticleArrays::ParticleArrays():
+    xs{nullptr}, ys{nullptr}, dxs{nullptr}, dys{nullptr}, lifes{nullptr}, count{0}, cap{0} {}
+
+static std::shared_ptr<void> allocateBlock(size_t bytes){
+    void* block = ::operator new(bytes, std::align_val_t{ParticleArrays::ALIGNMENT});
+    return std::shared_ptr<void>(block, [](void* p){ ::operator delete(p, std::align_val_t{ParticleArrays::ALIGNMENT}); });
+}
+
+ParticleArrays::ParticleArrays(ParticleArrays&& other) noexcept:
+    xs{other.xs}, ys{other.ys}, dxs{other.dxs}, dys{other.dys}, lifes{other.lifes},
+    count{other.count}, cap{other.cap},
+    storage{std::move(other.storage)}, lifeStorage{std::move(other.lifeStorage)} {
+    other.xs = other.ys = other.dxs = other.dys = other.lifes = nullptr;
+    other.count = 0;
+    other.cap = 0;
+}
+
+ParticleArrays& ParticleArrays::operator=(ParticleArrays&& other) noexcept{
+    if(this != &other){
+        xs = other.xs; ys = other.ys; dxs = other.dxs; dys = other.dys; lifes = other.lifes;
+        count = other.count;
+        cap = other.cap;
+        storage = std::move(other.storage);
+        lifeStorage = std::move(other.lifeStorage);
+        other.xs = other.ys = other.dxs = other.dys = other.lifes = nullptr;
+        other.count = 0;
+        other.cap = 0;
+    }
+    return *this;
+}
+
+void ParticleArrays::grow(size_t newCap){
+    size_t stride = streamBytes(newCap);
+    std::shared_ptr<void> newStorage = allocateBlock(stride * STREAMS);
+
+    char* base = static_cast<char*>(newStorage.get());
+    double* newX = reinterpret_cast<double*>(base);
+    double* newY = reinterpret_cast<double*>(base + stride);
+    double* newDx = reinterpret_cast<double*>(base + 2 * stride);
+    double* newDy = reinterpret_cast<double*>(base + 3 * stride);
+
+    if(count > 0){
+        std::memcpy(newX, xs, count * sizeof(double));
+        std::memcpy(newY, ys, count * sizeof(double));
+        std::memcpy(newDx, dxs, count * sizeof(double));
+        std::memcpy(newDy, dys, count * sizeof(double));
+    }
+    if(lifes){
+        std::shared_ptr<void> newLifeStorage = allocateBlock(stride);
+        double* newLife = static_cast<double*>(newLifeStorage.get());
+        std::memcpy(newLife, lifes, count * sizeof(double));
+        lifes = newLife;
+        lifeStorage = std::move(newLifeStorage);
+    }
+
+    xs = newX; ys = newY; dxs = newDx; dys = newDy;
+    cap = newCap;
+    storage = std::move(newStorage);
+}
+
+void ParticleArrays::enableLife(){
+    if(lifes){
+        return;
+    }
+    if(cap == 0){
+        grow(64);
+    }
+    lifeStorage = allocateBlock(streamBytes(cap));
+    lifes = static_cast<double*>(lifeStorage.get());
+    std::fill(lifes, lifes + count, IMMORTAL);
+}
+
+ParticleArrays ParticleArrays::adopt(std::shared_ptr<void> storage, double* x, double* y, double* dx, double* dy,
+                                     double* life, size_t count, size_t capacity){
+    ParticleArrays arrays;
+    arrays.xs = x; arrays.ys = y; arrays.dxs = dx; arrays.dys = dy; arrays.lifes = life;
+    arrays.count = count;
+    arrays.cap = capacity;
+    if(life){
+        arrays.lifeStorage = storage;
+    }
+    arrays.storage = std::move(storage);
+    return arrays;
+}
+
+void ParticleArrays::reserve(size_t n){
+    if(n > cap){
+        grow(n);
+    }
+}
+
+void ParticleArrays::push(double x, double y, double dx, double dy, double life){
+    if(count == cap){
+        grow(cap == 0 ? 64 : cap * 2);
+    }
+    xs[count] = x;
+    ys[count] = y;
+    dxs[count] = dx;
+    dys[count] = dy;
+    if(!lifes && life != IMMORTAL){
+        enableLife();
+    }
+    if(lifes){
+        lifes[count] = life;
+    }
+    ++count;
+}
+
+void ParticleArrays::clear(){
+    count = 0;
+    lifes = nullptr;
+    lifeStorage.reset();
+}
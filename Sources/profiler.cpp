@@ -0,0 +1,97 @@
+#include "../Libraries/profiler.h"
+#include <algorithm>
+
+FrameProfiler::FrameProfiler(): history(WINDOW * PHASES, 0.0f), frames{0}, lastEnd{std::chrono::steady_clock::now()}, csv{nullptr} {
+    for(int p = 0; p < PHASES; ++p){
+        current[p].store(0, std::memory_order_relaxed);
+    }
+}
+
+FrameProfiler::~FrameProfiler(){
+    closeCsv();
+}
+
+FrameProfiler& FrameProfiler::instance(){
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+const char* FrameProfiler::phaseName(ProfilePhase phase){
+    switch(phase){
+        case ProfilePhase::Simulation: return "simulacao";
+        case ProfilePhase::ParticleHash: return "hash";
+        case ProfilePhase::ParticleCollision: return "particulas";
+        case ProfilePhase::Move: return "movimento";
+        case ProfilePhase::Limits: return "limites";
+        case ProfilePhase::Segments: return "segmentos";
+        case ProfilePhase::Render: return "render";
+        case ProfilePhase::Swap: return "swap";
+        case ProfilePhase::Frame: return "frame";
+        default: return "?";
+    }
+}
+
+void FrameProfiler::endFrame(){
+    auto now = std::chrono::steady_clock::now();
+    add(ProfilePhase::Frame, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastEnd).count()));
+    lastEnd = now;
+
+    float* row = &history[(frames % WINDOW) * PHASES];
+    for(int p = 0; p < PHASES; ++p){
+        row[p] = static_cast<float>(current[p].exchange(0, std::memory_order_relaxed) * 1e-6);
+    }
+
+    if(csv){
+        std::fprintf(csv, "%zu", frames);
+        for(int p = 0; p < PHASES; ++p){
+            std::fprintf(csv, ",%.4f", row[p]);
+        }
+        std::fputc('\n', csv);
+    }
+    ++frames;
+}
+
+PhaseStats FrameProfiler::stats(ProfilePhase phase) const{
+    const size_t count = std::min(frames, WINDOW);
+    if(count == 0){
+        return PhaseStats{0.0, 0.0, 0.0};
+    }
+
+    float values[WINDOW];
+    double sum = 0.0;
+    for(size_t f = 0; f < count; ++f){
+        values[f] = history[f * PHASES + static_cast<int>(phase)];
+        sum += values[f];
+    }
+    size_t p99 = std::min(count - 1, (count * 99) / 100);
+    std::nth_element(values, values + p99, values + count);
+    double p99Ms = values[p99];
+    double minMs = *std::min_element(values, values + count);
+
+    return PhaseStats{minMs, sum / count, p99Ms};
+}
+
+size_t FrameProfiler::get_frames() const{
+    return frames;
+}
+
+bool FrameProfiler::openCsv(const char* path){
+    closeCsv();
+    csv = std::fopen(path, "w");
+    if(!csv){
+        return false;
+    }
+    std::fprintf(csv, "frame");
+    for(int p = 0; p < PHASES; ++p){
+        std::fprintf(csv, ",%s_ms", phaseName(static_cast<ProfilePhase>(p)));
+    }
+    std::fputc('\n', csv);
+    return true;
+}
+
+void FrameProfiler::closeCsv(){
+    if(csv){
+        std::fclose(csv);
+        csv = nullptr;
+    }
+}
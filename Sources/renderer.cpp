@@ -0,0 +1,342 @@
+#include "../Libraries/renderer.h"
+#include "glm/gtc/type_ptr.hpp"
+#include <algorithm>
+#include <cstring>
+
+// Constantes do GL 4.4 / ARB_buffer_storage (ausentes no glad gerado para 4.3).
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+static bool hasExtension(const char* name){
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0; i < count; ++i){
+        const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if(ext && std::strcmp(ext, name) == 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+StreamBuffer::StreamBuffer():
+    buffer{0}, regionBytes{0}, region{0}, persistent{false}, mapped{nullptr},
+    fences{nullptr, nullptr, nullptr}, bufferStorage{nullptr} {}
+
+void StreamBuffer::init(GLADloadproc loader){
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool supported = (major > 4 || (major == 4 && minor >= 4)) || hasExtension("GL_ARB_buffer_storage");
+    if(supported){
+        bufferStorage = reinterpret_cast<void (APIENTRYP)(GLenum, GLsizeiptr, const void*, GLbitfield)>(loader("glBufferStorage"));
+    }
+    persistent = bufferStorage != nullptr;
+    glGenBuffers(1, &buffer);
+}
+
+void StreamBuffer::release(){
+    waitAll();
+    if(buffer != 0){
+        if(mapped){
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            mapped = nullptr;
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    regionBytes = 0;
+}
+
+void StreamBuffer::waitFence(int r){
+    if(fences[r]){
+        // Espera a GPU terminar de ler a região (em geral já terminou há 2 frames).
+        while(glClientWaitSync(fences[r], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED){}
+        glDeleteSync(fences[r]);
+        fences[r] = nullptr;
+    }
+}
+
+void StreamBuffer::waitAll(){
+    for(int r = 0; r < REGIONS; ++r){
+        waitFence(r);
+    }
+}
+
+// Cria o armazenamento para regiões de pelo menos bytes (crescendo em potências de 2).
+void StreamBuffer::allocate(size_t bytes){
+    size_t newBytes = regionBytes == 0 ? 16 * 1024 : regionBytes;
+    while(newBytes < bytes){
+        newBytes *= 2;
+    }
+
+    if(persistent){
+        // Armazenamento imutável: para crescer é preciso um buffer novo.
+        waitAll();
+        if(mapped){
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        glDeleteBuffers(1, &buffer);
+        glGenBuffers(1, &buffer);
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        bufferStorage(GL_ARRAY_BUFFER, newBytes * REGIONS, nullptr, flags);
+        mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, newBytes * REGIONS, flags);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        region = 0;
+    }
+    regionBytes = newBytes;
+}
+
+void* StreamBuffer::map(size_t bytes){
+    if(bytes > regionBytes){
+        allocate(bytes);
+    }
+
+    if(persistent){
+        waitFence(region);
+        return static_cast<char*>(mapped) + region * regionBytes;
+    }
+
+    // Orfanamento: o driver entrega um armazenamento novo se o antigo ainda estiver em uso.
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, regionBytes, nullptr, GL_STREAM_DRAW);
+    return glMapBufferRange(GL_ARRAY_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+}
+
+size_t StreamBuffer::unmap(){
+    if(persistent){
+        return region * regionBytes;
+    }
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return 0;
+}
+
+void StreamBuffer::fence(){
+    if(persistent){
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region = (region + 1) % REGIONS;
+    }
+}
+
+ParticleRenderer::ParticleRenderer():
+    vao{0}, colorVBO{0}, colorCapacity{0} {}
+
+void ParticleRenderer::release(){
+    positionStream.release();
+    if(vao != 0){
+        glDeleteBuffers(1, &colorVBO);
+        glDeleteVertexArrays(1, &vao);
+        vao = colorVBO = 0;
+        colorCapacity = 0;
+    }
+}
+
+void ParticleRenderer::init(GLADloadproc loader){
+    positionStream.init(loader);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &colorVBO);
+
+    glBindVertexArray(vao);
+    glEnableVertexAttribArray(0); // Posição: apontada para a região do frame em draw()
+
+    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+// Cresce o buffer de cor em potências de 2 para não realocar a cada particula nova. A cor
+// não depende da particula, então o buffer é preenchido inteiro (até a capacidade) uma vez
+// por crescimento e os frames em que n muda não enviam nada.
+void ParticleRenderer::ensureColorCapacity(size_t n){
+    if(n <= colorCapacity){
+        return;
+    }
+    size_t newCap = colorCapacity == 0 ? 1024 : colorCapacity;
+    while(newCap < n){
+        newCap *= 2;
+    }
+
+    // Todas as particulas em cinza, como antes.
+    std::vector<float> colors(newCap * 3, 0.5f);
+    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
+    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(float), colors.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    colorCapacity = newCap;
+}
+
+void ParticleRenderer::draw(const World& world, unsigned int shaderProgram, const glm::mat4& projection){
+    const size_t n = world.getParticles().size();
+    if(n == 0){
+        return;
+    }
+    ensureColorCapacity(n);
+
+    // O World escreve as posições direto na memória do buffer de streaming.
+    float* dst = static_cast<float*>(positionStream.map(n * 2 * sizeof(float)));
+    world.writePositions(dst);
+    size_t offset = positionStream.unmap();
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, positionStream.id());
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), reinterpret_cast<void*>(offset));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glUseProgram(shaderProgram);
+    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+    glPointSize(7.0f);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(n));
+    glBindVertexArray(0);
+
+    positionStream.fence();
+}
+
+SegmentRenderer::SegmentRenderer():
+    vao{0}, vbo{0}, capacity{0}, pointCount{0}, revision{0}, uploaded{false} {}
+
+void SegmentRenderer::init(){
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void SegmentRenderer::release(){
+    if(vao != 0){
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        vao = vbo = 0;
+        capacity = pointCount = 0;
+        uploaded = false;
+    }
+}
+
+void SegmentRenderer::upload(const World& world){
+    pointCount = world.getSegs().size();
+    if(pointCount == 0){
+        return;
+    }
+
+    vertices.resize(pointCount * 2);
+    world.writeSegmentVertices(vertices.data());
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if(pointCount > capacity){
+        capacity = pointCount * 2;
+        glBufferData(GL_ARRAY_BUFFER, capacity * 2 * sizeof(float), nullptr, GL_STATIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, pointCount * 2 * sizeof(float), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SegmentRenderer::draw(const World& world, unsigned int shaderProgram, const glm::mat4& projection, float red, float green, float blue){
+    if(!uploaded || revision != world.getSegsRevision()){
+        upload(world);
+        revision = world.getSegsRevision();
+        uploaded = true;
+    }
+    if(pointCount == 0){
+        return;
+    }
+
+    glUseProgram(shaderProgram);
+    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform3f(glGetUniformLocation(shaderProgram, "color"), red, green, blue);
+
+    glBindVertexArray(vao);
+    // Um ponto sem par (último clique) aparece só como extremidade.
+    glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(pointCount / 2 * 2));
+    glPointSize(7.0f);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(pointCount));
+    glBindVertexArray(0);
+}
+
+ProfilerOverlay::ProfilerOverlay(): vao{0}, vbo{0} {}
+
+void ProfilerOverlay::init(){
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void ProfilerOverlay::release(){
+    if(vao != 0){
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        vao = vbo = 0;
+    }
+}
+
+void ProfilerOverlay::draw(const FrameProfiler& profiler, unsigned int shaderProgram, double budgetMs){
+    const int phases = static_cast<int>(ProfilePhase::COUNT);
+    const float left = -0.98f;
+    const float top = 0.96f;
+    const float width = 0.6f;   // largura (NDC) equivalente a budgetMs
+    const float height = 0.03f;
+    const float gap = 0.015f;
+
+    // Por fase: 6 vértices da barra (dois triângulos) seguidos dos 2 do traço do p99.
+    vertices.clear();
+    for(int p = 0; p < phases; ++p){
+        PhaseStats st = profiler.stats(static_cast<ProfilePhase>(p));
+        float y1 = top - p * (height + gap);
+        float y0 = y1 - height;
+        float x1 = left + width * static_cast<float>(std::min(st.avgMs / budgetMs, 1.0));
+        float xp = left + width * static_cast<float>(std::min(st.p99Ms / budgetMs, 1.0));
+        const float quad[] = {left, y0, x1, y0, x1, y1, left, y0, x1, y1, left, y1, xp, y0 - 0.005f, xp, y1 + 0.005f};
+        vertices.insert(vertices.end(), quad, quad + 16);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glm::mat4 identity{1.0f};
+    glUseProgram(shaderProgram);
+    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(identity));
+    GLint colorLocation = glGetUniformLocation(shaderProgram, "color");
+
+    glBindVertexArray(vao);
+    for(int p = 0; p < phases; ++p){
+        // Tons alternados para separar as barras; o frame completo em branco.
+        if(p == phases - 1){
+            glUniform3f(colorLocation, 1.0f, 1.0f, 1.0f);
+        }else if(p % 2 == 0){
+            glUniform3f(colorLocation, 0.2f, 0.6f, 1.0f);
+        }else{
+            glUniform3f(colorLocation, 1.0f, 0.7f, 0.2f);
+        }
+        glDrawArrays(GL_TRIANGLES, p * 8, 6);
+        glUniform3f(colorLocation, 1.0f, 0.0f, 0.0f);
+        glDrawArrays(GL_LINES, p * 8 + 6, 2);
+    }
+    glBindVertexArray(0);
+}
@@ -0,0 +1,512 @@
+#include "../Libraries/replay.h"
+#include "../Libraries/scene.h"
+#include <cstring>
+
+SimulationRecorder::SimulationRecorder(): file{nullptr}, lastTick{0}, hashInterval{60}, dt{0.0} {}
+
+SimulationRecorder::~SimulationRecorder(){
+    if(file){
+        std::fclose(file);
+    }
+}
+
+bool SimulationRecorder::begin(const char* path, World& world, uint64_t seed, double dt, unsigned hashInterval){
+    file = std::fopen(path, "wb");
+    if(!file){
+        return false;
+    }
+    this->dt = dt;
+    this->hashInterval = hashInterval > 0 ? hashInterval : 1;
+    lastTick = world.get_stepCount();
+    world.setSeed(seed);
+
+    std::fwrite("PPRP", 1, 4, file);
+    writeRaw(FORMAT_VERSION);
+    writeRaw(seed);
+    writeRaw(world.get_xMin());
+    writeRaw(world.get_xMax());
+    writeRaw(world.get_yMin());
+    writeRaw(world.get_yMax());
+    writeRaw(dt);
+    writeRaw(static_cast<uint32_t>(this->hashInterval));
+
+    writeRaw(world.get_speed());
+    writeRaw(static_cast<uint8_t>(world.getBroadPhase()));
+    writeRaw(static_cast<uint8_t>(world.getCollisionMode()));
+    writeRaw(static_cast<uint8_t>(world.getBoundary()));
+    writeRaw(world.getParticleRadius());
+    writeRaw(world.getParticleLifetime());
+    writeRaw(static_cast<uint64_t>(world.getParticleCapacity()));
+
+    const std::vector<ponto2D>& segs = world.getSegs();
+    writeRaw(static_cast<uint64_t>(segs.size()));
+    for(const ponto2D& p : segs){
+        writeRaw(p.x);
+        writeRaw(p.y);
+    }
+    const ParticleArrays& particles = world.getParticles();
+    writeRaw(static_cast<uint64_t>(particles.size()));
+    for(size_t i = 0; i < particles.size(); ++i){
+        writeRaw(particles.x()[i]);
+        writeRaw(particles.y()[i]);
+        writeRaw(particles.dx()[i]);
+        writeRaw(particles.dy()[i]);
+        writeRaw(particles.life() ? particles.life()[i] : ParticleArrays::IMMORTAL);
+    }
+    const std::vector<Emitter>& emitters = world.getEmitters();
+    writeRaw(static_cast<uint64_t>(emitters.size()));
+    for(const Emitter& e : emitters){
+        writeEmitter(e);
+    }
+    const SegmentTable& table = world.getSegmentTable();
+    uint64_t absorbing = 0;
+    for(size_t s = 0; s < table.size(); ++s){
+        absorbing += table.absorbs(s) ? 1 : 0;
+    }
+    writeRaw(absorbing);
+    for(size_t s = 0; s < table.size(); ++s){
+        if(table.absorbs(s)){
+            writeVarint(s);
+        }
+    }
+
+    world.setRecorder(this);
+    return true;
+}
+
+void SimulationRecorder::finish(World& world){
+    if(!file){
+        return;
+    }
+    op(ReplayOp::End, world.get_stepCount());
+    world.setRecorder(nullptr);
+    std::fclose(file);
+    file = nullptr;
+}
+
+void SimulationRecorder::writeVarint(uint64_t v){
+    uint8_t bytes[10];
+    int n = 0;
+    do{
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        bytes[n++] = static_cast<uint8_t>(b | (v ? 0x80 : 0));
+    }while(v);
+    std::fwrite(bytes, 1, n, file);
+}
+
+void SimulationRecorder::op(ReplayOp op, unsigned long tick){
+    writeRaw(static_cast<uint8_t>(op));
+    writeVarint(tick - lastTick);
+    lastTick = tick;
+}
+
+void SimulationRecorder::addSegmentPoint(unsigned long tick, const ponto2D& p){
+    op(ReplayOp::AddSegmentPoint, tick);
+    writeRaw(p.x);
+    writeRaw(p.y);
+}
+
+void SimulationRecorder::randomSegs(unsigned long tick, int count){
+    op(ReplayOp::RandomSegs, tick);
+    writeVarint(static_cast<uint64_t>(count));
+}
+
+void SimulationRecorder::loadSegments(unsigned long tick, const std::vector<ponto2D>& points){
+    op(ReplayOp::LoadSegments, tick);
+    writeVarint(points.size());
+    std::fwrite(points.data(), sizeof(ponto2D), points.size(), file);
+}
+
+void SimulationRecorder::addParticle(unsigned long tick, const ponto2D& p){
+    op(ReplayOp::AddParticle, tick);
+    writeRaw(p.x);
+    writeRaw(p.y);
+}
+
+void SimulationRecorder::addParticle(unsigned long tick, const ponto2D& p, const vec2& dir){
+    op(ReplayOp::AddParticleDir, tick);
+    writeRaw(p.x);
+    writeRaw(p.y);
+    writeRaw(dir.x);
+    writeRaw(dir.y);
+}
+
+void SimulationRecorder::reset(unsigned long tick){
+    op(ReplayOp::Reset, tick);
+}
+
+void SimulationRecorder::setSpeed(unsigned long tick, float speed){
+    op(ReplayOp::SetSpeed, tick);
+    writeRaw(speed);
+}
+
+void SimulationRecorder::setBroadPhase(unsigned long tick, BroadPhase bp){
+    op(ReplayOp::SetBroadPhase, tick);
+    writeRaw(static_cast<uint8_t>(bp));
+}
+
+void SimulationRecorder::setCollisionMode(unsigned long tick, CollisionMode mode){
+    op(ReplayOp::SetCollisionMode, tick);
+    writeRaw(static_cast<uint8_t>(mode));
+}
+
+void SimulationRecorder::setBoundary(unsigned long tick, Boundary boundary){
+    op(ReplayOp::SetBoundary, tick);
+    writeRaw(static_cast<uint8_t>(boundary));
+}
+
+void SimulationRecorder::setRadius(unsigned long tick, double radius){
+    op(ReplayOp::SetRadius, tick);
+    writeRaw(radius);
+}
+
+void SimulationRecorder::setParticleCapacity(unsigned long tick, size_t capacity){
+    op(ReplayOp::SetCapacity, tick);
+    writeVarint(capacity);
+}
+
+void SimulationRecorder::setParticleLifetime(unsigned long tick, double seconds){
+    op(ReplayOp::SetLifetime, tick);
+    writeRaw(seconds);
+}
+
+void SimulationRecorder::writeEmitter(const Emitter& e){
+    writeRaw(e.position.x);
+    writeRaw(e.position.y);
+    writeRaw(e.rate);
+    writeRaw(e.lifetime);
+    writeRaw(e.pending);
+}
+
+void SimulationRecorder::addEmitter(unsigned long tick, const Emitter& emitter){
+    op(ReplayOp::AddEmitter, tick);
+    writeEmitter(emitter);
+}
+
+void SimulationRecorder::setSegmentAbsorbing(unsigned long tick, uint32_t seg, bool absorbing){
+    op(ReplayOp::SetAbsorbing, tick);
+    writeVarint(seg);
+    writeRaw(static_cast<uint8_t>(absorbing ? 1 : 0));
+}
+
+void SimulationRecorder::stateHash(unsigned long tick, uint64_t hash){
+    op(ReplayOp::StateHash, tick);
+    writeRaw(hash);
+}
+
+// Leitura sequencial com checagem de limites sobre o arquivo carregado.
+// Maior capacidade aceita de uma gravação: acima disso é mais provável um arquivo
+// corrompido do que um pool real, e setParticleCapacity reservaria memória demais.
+static constexpr uint64_t MAX_CAPACITY = uint64_t(1) << 27;
+
+namespace{
+struct Reader{
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool ok;
+
+    template<typename T>
+    T raw(){
+        T v{};
+        if(pos + sizeof(T) > size){
+            ok = false;
+            return v;
+        }
+        std::memcpy(&v, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+
+    uint64_t varint(){
+        uint64_t v = 0;
+        for(int shift = 0; shift < 64; shift += 7){
+            if(pos >= size){
+                ok = false;
+                return 0;
+            }
+            uint8_t b = data[pos++];
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if(!(b & 0x80)){
+                return v;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    Emitter emitter(){
+        Emitter e;
+        e.position.x = raw<double>();
+        e.position.y = raw<double>();
+        e.rate = raw<double>();
+        e.lifetime = raw<double>();
+        e.pending = raw<double>();
+        return e;
+    }
+};
+}
+
+SimulationReplay::SimulationReplay(): commandsOffset{0}, dt{0.0}, hashInterval{0}, seed{0} {}
+
+bool SimulationReplay::load(const char* path, std::string& error){
+    std::FILE* f = std::fopen(path, "rb");
+    if(!f){
+        error = std::string("não foi possível abrir ") + path;
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    size_t read = data.empty() ? 0 : std::fread(data.data(), 1, data.size(), f);
+    std::fclose(f);
+    if(read != data.size()){
+        error = "erro de leitura";
+        return false;
+    }
+
+    Reader r{data.data(), data.size(), 0, true};
+    if(data.size() < 4 || std::memcmp(data.data(), "PPRP", 4) != 0){
+        error = "não é uma gravação (PPRP)";
+        return false;
+    }
+    r.pos = 4;
+    uint32_t version = r.raw<uint32_t>();
+    if(version < 1 || version > SimulationRecorder::FORMAT_VERSION){
+        error = "versão de gravação não suportada: " + std::to_string(version);
+        return false;
+    }
+    seed = r.raw<uint64_t>();
+    float xMin = r.raw<float>();
+    float xMax = r.raw<float>();
+    float yMin = r.raw<float>();
+    float yMax = r.raw<float>();
+    dt = r.raw<double>();
+    hashInterval = r.raw<uint32_t>();
+
+    float speed = r.raw<float>();
+    uint8_t bp = r.raw<uint8_t>();
+    uint8_t mode = r.raw<uint8_t>();
+    uint8_t boundary = version >= 2 ? r.raw<uint8_t>() : static_cast<uint8_t>(Boundary::Reflect);
+    double radius = r.raw<double>();
+    double lifetime = version >= 3 ? r.raw<double>() : ParticleArrays::IMMORTAL;
+    uint64_t capacity = version >= 3 ? r.raw<uint64_t>() : 0;
+    if(r.ok && (!validBroadPhase(bp) || !validCollisionMode(mode) || !validBoundary(boundary)
+                || hashInterval == 0 || capacity > MAX_CAPACITY)){
+        error = "gravação corrompida";
+        return false;
+    }
+
+    uint64_t segCount = r.raw<uint64_t>();
+    if(!r.ok || segCount > (r.size - r.pos) / 16){
+        error = "gravação truncada";
+        return false;
+    }
+    std::vector<ponto2D> segs;
+    segs.reserve(segCount);
+    for(uint64_t i = 0; i < segCount; ++i){
+        double x = r.raw<double>();
+        double y = r.raw<double>();
+        segs.emplace_back(x, y);
+    }
+    uint64_t particleCount = r.raw<uint64_t>();
+    const size_t particleBytes = version >= 3 ? 40 : 32;
+    if(!r.ok || particleCount > (r.size - r.pos) / particleBytes){
+        error = "gravação truncada";
+        return false;
+    }
+    ParticleArrays particles;
+    particles.reserve(particleCount);
+    for(uint64_t i = 0; i < particleCount; ++i){
+        double x = r.raw<double>();
+        double y = r.raw<double>();
+        double dx = r.raw<double>();
+        double dy = r.raw<double>();
+        double life = version >= 3 ? r.raw<double>() : ParticleArrays::IMMORTAL;
+        particles.push(x, y, dx, dy, life);
+    }
+    std::vector<Emitter> emitters;
+    std::vector<uint32_t> absorbing;
+    if(version >= 3){
+        uint64_t emitterCount = r.raw<uint64_t>();
+        if(!r.ok || emitterCount > (r.size - r.pos) / 40){
+            error = "gravação truncada";
+            return false;
+        }
+        for(uint64_t i = 0; i < emitterCount; ++i){
+            emitters.push_back(r.emitter());
+        }
+        uint64_t absorbingCount = r.raw<uint64_t>();
+        if(!r.ok || absorbingCount > r.size - r.pos){
+            error = "gravação truncada";
+            return false;
+        }
+        for(uint64_t i = 0; i < absorbingCount; ++i){
+            absorbing.push_back(static_cast<uint32_t>(r.varint()));
+        }
+    }
+    if(!r.ok){
+        error = "gravação truncada";
+        return false;
+    }
+    commandsOffset = r.pos;
+
+    // As configurações vão direto para o World novo, antes do estado, como na gravação.
+    world.reset(new World{xMin, xMax, yMin, yMax, speed});
+    world->setBroadPhase(static_cast<BroadPhase>(bp));
+    world->setCollisionMode(static_cast<CollisionMode>(mode));
+    world->setBoundary(static_cast<Boundary>(boundary));
+    world->setParticleRadius(radius);
+    world->setSeed(seed);
+    world->setParticleLifetime(lifetime);
+    world->restore(segs, std::move(particles), 0.0);
+    world->setParticleCapacity(capacity);
+    for(const Emitter& e : emitters){
+        world->addEmitter(e);
+    }
+    for(uint32_t seg : absorbing){
+        world->setSegmentAbsorbing(seg, true);
+    }
+    return true;
+}
+
+ReplayResult SimulationReplay::run(bool stopOnMismatch){
+    ReplayResult result{0, 0, 0, true};
+    Reader r{data.data(), data.size(), commandsOffset, true};
+    World& w = *world;
+
+    while(r.ok && r.pos < r.size){
+        ReplayOp op = static_cast<ReplayOp>(r.raw<uint8_t>());
+        uint64_t delta = r.varint();
+        // O gravador guarda um StateHash a cada hashInterval passos, então nenhum registro
+        // está mais longe que isso do anterior; um delta maior é arquivo corrompido.
+        if(!r.ok || delta > hashInterval){
+            r.ok = false;
+            break;
+        }
+        for(uint64_t s = 0; s < delta; ++s){
+            w.step(dt);
+            ++result.steps;
+        }
+
+        switch(op){
+            case ReplayOp::AddSegmentPoint:{
+                double x = r.raw<double>();
+                double y = r.raw<double>();
+                w.addSegmentPoint(ponto2D{x, y});
+                break;
+            }
+            case ReplayOp::RandomSegs:
+                w.randomSegs(static_cast<int>(r.varint()));
+                break;
+            case ReplayOp::LoadSegments:{
+                uint64_t count = r.varint();
+                if(!r.ok || count > (r.size - r.pos) / 16){
+                    r.ok = false;
+                    break;
+                }
+                std::vector<ponto2D> points;
+                points.reserve(count);
+                for(uint64_t i = 0; i < count; ++i){
+                    double x = r.raw<double>();
+                    double y = r.raw<double>();
+                    points.emplace_back(x, y);
+                }
+                w.loadSegments(SceneLoader::fromPoints(points));
+                break;
+            }
+            case ReplayOp::AddParticle:{
+                double x = r.raw<double>();
+                double y = r.raw<double>();
+                w.addParticle(ponto2D{x, y});
+                break;
+            }
+            case ReplayOp::AddParticleDir:{
+                double x = r.raw<double>();
+                double y = r.raw<double>();
+                double dx = r.raw<double>();
+                double dy = r.raw<double>();
+                w.addParticle(ponto2D{x, y}, vec2{dx, dy});
+                break;
+            }
+            case ReplayOp::Reset:
+                w.reset();
+                break;
+            case ReplayOp::SetSpeed:
+                w.setSpeed(r.raw<float>());
+                break;
+            // Um valor fora do enum é tratado como o fim de uma gravação corrompida.
+            case ReplayOp::SetBroadPhase:{
+                uint8_t v = r.raw<uint8_t>();
+                if(!validBroadPhase(v)){
+                    r.ok = false;
+                    break;
+                }
+                w.setBroadPhase(static_cast<BroadPhase>(v));
+                break;
+            }
+            case ReplayOp::SetCollisionMode:{
+                uint8_t v = r.raw<uint8_t>();
+                if(!validCollisionMode(v)){
+                    r.ok = false;
+                    break;
+                }
+                w.setCollisionMode(static_cast<CollisionMode>(v));
+                break;
+            }
+            case ReplayOp::SetBoundary:{
+                uint8_t v = r.raw<uint8_t>();
+                if(!validBoundary(v)){
+                    r.ok = false;
+                    break;
+                }
+                w.setBoundary(static_cast<Boundary>(v));
+                break;
+            }
+            case ReplayOp::SetRadius:
+                w.setParticleRadius(r.raw<double>());
+                break;
+            case ReplayOp::SetCapacity:{
+                uint64_t capacity = r.varint();
+                if(!r.ok || capacity > MAX_CAPACITY){
+                    r.ok = false;
+                    break;
+                }
+                w.setParticleCapacity(capacity);
+                break;
+            }
+            case ReplayOp::SetLifetime:
+                w.setParticleLifetime(r.raw<double>());
+                break;
+            case ReplayOp::AddEmitter:
+                w.addEmitter(r.emitter());
+                break;
+            case ReplayOp::SetAbsorbing:{
+                uint32_t seg = static_cast<uint32_t>(r.varint());
+                w.setSegmentAbsorbing(seg, r.raw<uint8_t>() != 0);
+                break;
+            }
+            case ReplayOp::StateHash:{
+                uint64_t expected = r.raw<uint64_t>();
+                ++result.hashesChecked;
+                if(r.ok && w.stateHash() != expected && result.ok){
+                    result.ok = false;
+                    result.firstMismatch = result.steps;
+                    if(stopOnMismatch){
+                        return result;
+                    }
+                }
+                break;
+            }
+            case ReplayOp::End:
+                return result;
+            default:
+                r.ok = false;
+                break;
+        }
+    }
+    // Sem End: gravação interrompida (ou corrompida); o que foi lido até aqui vale.
+    return result;
+}
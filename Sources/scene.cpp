@@ -0,0 +1,252 @@
+#include "../Libraries/scene.h"
+#include "../Libraries/collision.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+static constexpr uint64_t ARRAY_ALIGNMENT = 64;
+
+static_assert(sizeof(ponto2D) == 2 * sizeof(double), "ponto2D precisa ser dois doubles");
+static_assert(sizeof(vec2) == 2 * sizeof(double), "vec2 precisa ser dois doubles");
+static_assert(sizeof(SegmentBox) == 4 * sizeof(double), "SegmentBox precisa ser quatro doubles");
+
+static uint64_t alignUp(uint64_t v, uint64_t alignment){
+    return (v + alignment - 1) / alignment * alignment;
+}
+
+void SceneSegments::reserve(size_t segments){
+    points.reserve(2 * segments);
+    normals.reserve(segments);
+    boxes.reserve(segments);
+}
+
+void SceneSegments::clear(){
+    points.clear();
+    normals.clear();
+    boxes.clear();
+}
+
+void SceneSegments::add(const ponto2D& a, const ponto2D& b){
+    points.push_back(a);
+    points.push_back(b);
+    normals.push_back(segmentNormal(a, b));
+    boxes.push_back(segmentBox(a, b));
+}
+
+SceneSegments SceneLoader::fromPoints(const std::vector<ponto2D>& points){
+    SceneSegments scene;
+    scene.reserve(points.size() / 2);
+    for(size_t i = 0; i + 1 < points.size(); i += 2){
+        scene.add(points[i], points[i + 1]);
+    }
+    return scene;
+}
+
+bool SceneLoader::load(const char* path, SceneSegments& scene, std::string& error){
+    std::FILE* f = std::fopen(path, "rb");
+    if(!f){
+        error = std::string("não foi possível abrir ") + path + ": " + std::strerror(errno);
+        return false;
+    }
+    char magic[4] = {};
+    size_t read = std::fread(magic, 1, 4, f);
+    std::fclose(f);
+    if(read == 4 && std::memcmp(magic, "PPSC", 4) == 0){
+        return loadBinary(path, scene, error);
+    }
+    return loadText(path, scene, error);
+}
+
+bool SceneLoader::loadText(const char* path, SceneSegments& scene, std::string& error){
+    std::FILE* f = std::fopen(path, "rb");
+    if(!f){
+        error = std::string("não foi possível abrir ") + path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    // std::string termina em '\0': as leituras de *p nunca passam do fim.
+    std::string text(size > 0 ? static_cast<size_t>(size) : 0, '\0');
+    size_t read = text.empty() ? 0 : std::fread(&text[0], 1, text.size(), f);
+    std::fclose(f);
+    if(read != text.size()){
+        error = "erro de leitura";
+        return false;
+    }
+
+    // Uma linha por segmento, no máximo: contar as quebras de linha é uma passada linear
+    // e evita tanto o crescimento dos vetores quanto reservar pelo pior caso.
+    scene.clear();
+    scene.reserve(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
+    const char* p = text.c_str();
+    const char* end = p + text.size();
+    unsigned long line = 1;
+    while(p < end){
+        while(*p == ' ' || *p == '\t' || *p == '\r'){
+            ++p;
+        }
+        if(*p == '\n'){
+            ++p;
+            ++line;
+            continue;
+        }
+        if(*p != '#' && p < end){
+            double v[4];
+            for(double& value : v){
+                while(*p == ' ' || *p == '\t'){
+                    ++p;
+                }
+                // from_chars não aceita '+' (strtod aceita); o resto é o mesmo formato.
+                if(*p == '+'){
+                    ++p;
+                }
+                std::from_chars_result r = std::from_chars(p, end, value);
+                if(r.ec != std::errc()){
+                    error = "linha " + std::to_string(line) + ": esperados 4 números (x0 y0 x1 y1)";
+                    return false;
+                }
+                p = r.ptr;
+            }
+            while(*p == ' ' || *p == '\t' || *p == '\r'){
+                ++p;
+            }
+            if(*p != '\n' && *p != '#' && p < end){
+                error = "linha " + std::to_string(line) + ": texto depois do segmento";
+                return false;
+            }
+            scene.add(ponto2D{v[0], v[1]}, ponto2D{v[2], v[3]});
+        }
+        // Comentário (ou o resto da linha já lida).
+        while(p < end && *p != '\n'){
+            ++p;
+        }
+    }
+    return true;
+}
+
+// [offset, offset + bytes) cabe em [begin, limit)? Só subtrações, sem estouro de uint64_t,
+// e o início alinhado para os reinterpret_cast dos arrays.
+static bool arrayFits(uint64_t offset, uint64_t bytes, uint64_t begin, uint64_t limit){
+    return offset >= begin && offset <= limit && bytes <= limit - offset && offset % alignof(double) == 0;
+}
+
+bool SceneLoader::loadBinary(const char* path, SceneSegments& scene, std::string& error){
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0){
+        error = std::string("não foi possível abrir ") + path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(SceneFileHeader)){
+        ::close(fd);
+        error = "não é uma cena binária (arquivo curto)";
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(base == MAP_FAILED){
+        error = std::string("mmap falhou: ") + std::strerror(errno);
+        return false;
+    }
+    ::madvise(base, size, MADV_SEQUENTIAL);
+    const char* bytes = static_cast<const char*>(base);
+
+    SceneFileHeader h;
+    std::memcpy(&h, bytes, sizeof(h));
+    const uint64_t n = h.segmentCount;
+    bool ok = false;
+    if(std::memcmp(h.magic, "PPSC", 4) != 0 || h.endianTag != ENDIAN_TAG){
+        error = "não é uma cena binária (PPSC)";
+    }else if(h.version != FORMAT_VERSION || h.headerBytes != sizeof(SceneFileHeader)){
+        error = "versão de cena não suportada: " + std::to_string(h.version);
+    }else if(h.fileBytes != size || n > size / sizeof(SegmentBox)
+             || !arrayFits(h.pointsOffset, 2 * n * sizeof(ponto2D), sizeof(SceneFileHeader), size)
+             || !arrayFits(h.normalsOffset, n * sizeof(vec2), h.pointsOffset + 2 * n * sizeof(ponto2D), size)
+             || !arrayFits(h.boxesOffset, n * sizeof(SegmentBox), h.normalsOffset + n * sizeof(vec2), size)){
+        error = "cena truncada ou corrompida";
+    }else{
+        // Normais e caixas são copiadas sem conferir com os pontos (ver SceneLoader).
+        const ponto2D* points = reinterpret_cast<const ponto2D*>(bytes + h.pointsOffset);
+        const vec2* normals = reinterpret_cast<const vec2*>(bytes + h.normalsOffset);
+        const SegmentBox* boxes = reinterpret_cast<const SegmentBox*>(bytes + h.boxesOffset);
+        scene.points.assign(points, points + 2 * n);
+        scene.normals.assign(normals, normals + n);
+        scene.boxes.assign(boxes, boxes + n);
+        ok = true;
+    }
+    ::munmap(base, size);
+    return ok;
+}
+
+bool SceneLoader::saveText(const SceneSegments& scene, const char* path, std::string& error){
+    std::FILE* f = std::fopen(path, "wb");
+    if(!f){
+        error = std::string("não foi possível criar ") + path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::fputs("# x0 y0 x1 y1\n", f);
+    // to_chars escreve o menor texto que volta exatamente ao mesmo double.
+    char line[4 * 32];
+    for(size_t s = 0; s < scene.size(); ++s){
+        const ponto2D& a = scene.points[2 * s];
+        const ponto2D& b = scene.points[2 * s + 1];
+        char* p = line;
+        for(double v : {a.x, a.y, b.x, b.y}){
+            p = std::to_chars(p, line + sizeof(line) - 1, v).ptr;
+            *p++ = ' ';
+        }
+        p[-1] = '\n';
+        std::fwrite(line, 1, p - line, f);
+    }
+    if(std::fclose(f) != 0){
+        error = std::string("erro de escrita: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+bool SceneLoader::saveBinary(const SceneSegments& scene, const char* path, std::string& error){
+    const uint64_t n = scene.size();
+    SceneFileHeader h{};
+    std::memcpy(h.magic, "PPSC", 4);
+    h.version = FORMAT_VERSION;
+    h.headerBytes = sizeof(SceneFileHeader);
+    h.endianTag = ENDIAN_TAG;
+    h.segmentCount = n;
+    h.pointsOffset = alignUp(sizeof(SceneFileHeader), ARRAY_ALIGNMENT);
+    h.normalsOffset = alignUp(h.pointsOffset + 2 * n * sizeof(ponto2D), ARRAY_ALIGNMENT);
+    h.boxesOffset = alignUp(h.normalsOffset + n * sizeof(vec2), ARRAY_ALIGNMENT);
+    h.fileBytes = h.boxesOffset + n * sizeof(SegmentBox);
+
+    std::FILE* f = std::fopen(path, "wb");
+    if(!f){
+        error = std::string("não foi possível criar ") + path + ": " + std::strerror(errno);
+        return false;
+    }
+    static const char zeros[ARRAY_ALIGNMENT] = {};
+    uint64_t pos = 0;
+    auto put = [&](const void* data, uint64_t offset, uint64_t bytes){
+        std::fwrite(zeros, 1, offset - pos, f);
+        std::fwrite(data, 1, bytes, f);
+        pos = offset + bytes;
+    };
+    put(&h, 0, sizeof(h));
+    put(scene.points.data(), h.pointsOffset, 2 * n * sizeof(ponto2D));
+    put(scene.normals.data(), h.normalsOffset, n * sizeof(vec2));
+    put(scene.boxes.data(), h.boxesOffset, n * sizeof(SegmentBox));
+    if(std::fclose(f) != 0){
+        error = std::string("erro de escrita: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#include "../Libraries/segment_table.h"
+#include "../Libraries/collision.h"
+
+SegmentEntry SegmentTable::makeEntry(const ponto2D& a, const ponto2D& b){
+    return makeEntry(a, b, segmentNormal(a, b), segmentBox(a, b));
+}
+
+SegmentEntry SegmentTable::makeEntry(const ponto2D& a, const ponto2D& b, const vec2& normal, const SegmentBox& box){
+    return SegmentEntry{a, b, normal, box, b.y - a.y, a.x - b.x};
+}
+
+void SegmentTable::rebuild(const std::vector<ponto2D>& points){
+    entries.clear();
+    entries.reserve(points.size() / 2);
+    for(size_t i = 0; i + 1 < points.size(); i += 2){
+        entries.push_back(makeEntry(points[i], points[i + 1]));
+    }
+    absorbing.resize(entries.size(), 0);
+}
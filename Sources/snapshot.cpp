@@ -0,0 +1,316 @@
+#include "../Libraries/snapshot.h"
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+static constexpr uint64_t PAGE_ALIGNMENT = 4096;
+
+// Cabeçalho da versão 1, sem tempo de vida, capacidade, emissores nem segmentos
+// absorventes; os arrays eram só x, y, dx e dy.
+struct SnapshotHeaderV1{
+    char magic[4];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint32_t endianTag;
+
+    float xMin;
+    float xMax;
+    float yMin;
+    float yMax;
+    float speed;
+    uint8_t broadPhase;
+    uint8_t collisionMode;
+    uint8_t boundary;
+    uint8_t padding;
+
+    double radius;
+    double time;
+    uint64_t stepCount;
+    uint64_t seed;
+
+    uint64_t particleCount;
+    uint64_t particleStride;
+    uint64_t particlesOffset;
+    uint64_t segPointCount;
+    uint64_t segsOffset;
+    uint64_t rngOffset;
+    uint64_t rngBytes;
+    uint64_t fileBytes;
+};
+
+// Monta o cabeçalho atual a partir de um da versão 1: particulas IMMORTAL, sem emissores
+// nem marcas de absorção (as seções ficam vazias, logo antes do gerador).
+static SnapshotHeader fromV1(const SnapshotHeaderV1& v1){
+    SnapshotHeader h{};
+    std::memcpy(h.magic, v1.magic, 4);
+    h.version = v1.version;
+    h.headerBytes = v1.headerBytes;
+    h.endianTag = v1.endianTag;
+    h.xMin = v1.xMin;
+    h.xMax = v1.xMax;
+    h.yMin = v1.yMin;
+    h.yMax = v1.yMax;
+    h.speed = v1.speed;
+    h.broadPhase = v1.broadPhase;
+    h.collisionMode = v1.collisionMode;
+    h.boundary = v1.boundary;
+    h.radius = v1.radius;
+    h.time = v1.time;
+    h.particleLifetime = ParticleArrays::IMMORTAL;
+    h.particleCapacity = 0;
+    h.stepCount = v1.stepCount;
+    h.seed = v1.seed;
+    h.particleCount = v1.particleCount;
+    h.particleStride = v1.particleStride;
+    h.particlesOffset = v1.particlesOffset;
+    h.segPointCount = v1.segPointCount;
+    h.segsOffset = v1.segsOffset;
+    h.emitterCount = 0;
+    h.emittersOffset = v1.rngOffset;
+    h.absorbingOffset = v1.rngOffset;
+    h.rngOffset = v1.rngOffset;
+    h.rngBytes = v1.rngBytes;
+    h.fileBytes = v1.fileBytes;
+    return h;
+}
+
+static uint64_t alignUp(uint64_t v, uint64_t alignment){
+    return (v + alignment - 1) / alignment * alignment;
+}
+
+// Escreve todos os iovecs, continuando de onde um writev parcial parou.
+static bool writeAll(int fd, struct iovec* iov, int count){
+    while(count > 0){
+        ssize_t written = ::writev(fd, iov, count);
+        if(written < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return false;
+        }
+        size_t left = static_cast<size_t>(written);
+        while(count > 0 && left >= iov->iov_len){
+            left -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if(count > 0){
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+    return true;
+}
+
+bool WorldSnapshot::save(const World& world, const char* path, std::string& error){
+    const ParticleArrays& particles = world.particles;
+    const size_t n = particles.size();
+
+    std::ostringstream rngText;
+    rngText << world.rng;
+    const std::string rngState = rngText.str();
+
+    SnapshotHeader h{};
+    std::memcpy(h.magic, "PPSN", 4);
+    h.version = FORMAT_VERSION;
+    h.headerBytes = sizeof(SnapshotHeader);
+    h.endianTag = ENDIAN_TAG;
+    h.xMin = world.xMin;
+    h.xMax = world.xMax;
+    h.yMin = world.yMin;
+    h.yMax = world.yMax;
+    h.speed = world.speed;
+    h.broadPhase = static_cast<uint8_t>(world.broadPhase);
+    h.collisionMode = static_cast<uint8_t>(world.collisionMode);
+    h.boundary = static_cast<uint8_t>(world.boundary);
+    h.radius = world.radius;
+    h.time = world.time;
+    h.particleLifetime = world.particleLifetime;
+    h.particleCapacity = world.particleCapacity;
+    h.stepCount = world.stepCount;
+    h.seed = world.seed;
+    h.particleCount = n;
+    h.particleStride = alignUp(n * sizeof(double), ParticleArrays::ALIGNMENT);
+    h.particlesOffset = alignUp(sizeof(SnapshotHeader), PAGE_ALIGNMENT);
+    h.segPointCount = world.segs.size();
+    // O array de vida só vai para o arquivo se existir na memória.
+    const size_t streamCount = particles.life() ? ParticleArrays::STREAMS + 1 : ParticleArrays::STREAMS;
+    h.segsOffset = h.particlesOffset + streamCount * h.particleStride;
+    h.emitterCount = world.emitters.size();
+    h.emittersOffset = h.segsOffset + h.segPointCount * sizeof(ponto2D);
+    h.absorbingOffset = h.emittersOffset + h.emitterCount * sizeof(Emitter);
+    h.rngOffset = h.absorbingOffset + world.segTable.size();
+    h.rngBytes = rngState.size();
+    h.fileBytes = h.rngOffset + h.rngBytes;
+
+    // Os preenchimentos são sempre menores que uma página.
+    static const char zeros[PAGE_ALIGNMENT] = {};
+    const size_t streamPad = h.particleStride - n * sizeof(double);
+    const double* streams[ParticleArrays::STREAMS + 1] = {particles.x(), particles.y(), particles.dx(), particles.dy(),
+                                                          particles.life()};
+
+    struct iovec iov[2 + 2 * (ParticleArrays::STREAMS + 1) + 4];
+    int count = 0;
+    iov[count++] = {&h, sizeof(h)};
+    iov[count++] = {const_cast<char*>(zeros), h.particlesOffset - sizeof(h)};
+    for(size_t s = 0; s < streamCount; ++s){
+        iov[count++] = {const_cast<double*>(streams[s]), n * sizeof(double)};
+        iov[count++] = {const_cast<char*>(zeros), streamPad};
+    }
+    // ponto2D é só {double x, y}: o vetor já está no formato do arquivo.
+    static_assert(sizeof(ponto2D) == 2 * sizeof(double), "ponto2D precisa ser dois doubles");
+    iov[count++] = {const_cast<ponto2D*>(world.segs.data()), h.segPointCount * sizeof(ponto2D)};
+    static_assert(std::is_trivially_copyable<Emitter>::value, "Emitter é gravado como está na memória");
+    iov[count++] = {const_cast<Emitter*>(world.emitters.data()), h.emitterCount * sizeof(Emitter)};
+    iov[count++] = {const_cast<uint8_t*>(world.segTable.absorbingFlags()), world.segTable.size()};
+    iov[count++] = {const_cast<char*>(rngState.data()), rngState.size()};
+
+    const std::string tmpPath = std::string(path) + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0){
+        error = "não foi possível criar " + tmpPath + ": " + std::strerror(errno);
+        return false;
+    }
+    bool ok = writeAll(fd, iov, count);
+    if(!ok){
+        error = std::string("erro de escrita: ") + std::strerror(errno);
+    }
+    if(::close(fd) != 0 && ok){
+        error = std::string("erro ao fechar: ") + std::strerror(errno);
+        ok = false;
+    }
+    if(ok && std::rename(tmpPath.c_str(), path) != 0){
+        error = std::string("não foi possível renomear para ") + path + ": " + std::strerror(errno);
+        ok = false;
+    }
+    if(!ok){
+        ::unlink(tmpPath.c_str());
+    }
+    return ok;
+}
+
+std::unique_ptr<World> WorldSnapshot::load(const char* path, std::string& error){
+    int fd = ::open(path, O_RDONLY);
+    if(fd < 0){
+        error = std::string("não foi possível abrir ") + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(SnapshotHeader)){
+        ::close(fd);
+        error = "não é um snapshot (arquivo curto)";
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    // PROT_WRITE com MAP_PRIVATE: o passo altera os arrays no lugar (cópia na escrita)
+    // sem tocar no arquivo.
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(base == MAP_FAILED){
+        error = std::string("mmap falhou: ") + std::strerror(errno);
+        return nullptr;
+    }
+    std::shared_ptr<void> mapping(base, [size](void* p){ ::munmap(p, size); });
+    const char* bytes = static_cast<const char*>(base);
+
+    // magic, version, headerBytes e endianTag estão no mesmo lugar em todas as versões.
+    SnapshotHeader h;
+    std::memcpy(&h, bytes, sizeof(SnapshotHeaderV1));
+    if(std::memcmp(h.magic, "PPSN", 4) != 0 || h.endianTag != ENDIAN_TAG){
+        error = "não é um snapshot (PPSN)";
+        return nullptr;
+    }
+    if(h.version == 1 && h.headerBytes == sizeof(SnapshotHeaderV1)){
+        SnapshotHeaderV1 v1;
+        std::memcpy(&v1, bytes, sizeof(v1));
+        h = fromV1(v1);
+    }else if(h.version == FORMAT_VERSION && h.headerBytes == sizeof(SnapshotHeader)){
+        std::memcpy(&h, bytes, sizeof(h));
+    }else{
+        error = "versão de snapshot não suportada: " + std::to_string(h.version);
+        return nullptr;
+    }
+    // Sem o array de vida (versão 1, ou nenhuma particula expira) as particulas ficam
+    // IMMORTAL; com ele, é o quinto array.
+    // Cada campo é limitado por size antes de entrar em uma soma ou multiplicação, então
+    // nenhuma das contas abaixo estoura uint64_t (size é bem menor que 2^64 / 8).
+    if(h.fileBytes != size || h.particlesOffset < h.headerBytes || h.particlesOffset > size
+       || h.particlesOffset % ParticleArrays::ALIGNMENT != 0
+       || h.particleStride > (size - h.particlesOffset) / ParticleArrays::STREAMS
+       || h.particleStride % ParticleArrays::ALIGNMENT != 0
+       || h.particleCount > h.particleStride / sizeof(double)
+       || h.segPointCount > size / sizeof(ponto2D) || h.emitterCount > size / sizeof(Emitter)
+       || h.rngBytes > size){
+        error = "snapshot truncado ou corrompido";
+        return nullptr;
+    }
+    const uint64_t absorbingBytes = h.version == 1 ? 0 : h.segPointCount / 2;
+    const bool hasLife = h.version != 1 && h.particleStride > 0
+                         && h.segsOffset == h.particlesOffset + (ParticleArrays::STREAMS + 1) * h.particleStride;
+    const size_t streamCount = hasLife ? ParticleArrays::STREAMS + 1 : ParticleArrays::STREAMS;
+    // As seções vêm uma depois da outra até o fim do arquivo; cada uma é conferida com
+    // subtrações (cabe no que sobra) antes de calcular onde começa a próxima.
+    if(h.segsOffset != h.particlesOffset + streamCount * h.particleStride || h.segsOffset > size
+       || h.segPointCount * sizeof(ponto2D) > size - h.segsOffset
+       || h.emittersOffset != h.segsOffset + h.segPointCount * sizeof(ponto2D)
+       || h.emitterCount * sizeof(Emitter) > size - h.emittersOffset
+       || h.absorbingOffset != h.emittersOffset + h.emitterCount * sizeof(Emitter)
+       || absorbingBytes > size - h.absorbingOffset
+       || h.rngOffset != h.absorbingOffset + absorbingBytes
+       || h.rngBytes != size - h.rngOffset
+       || !validBroadPhase(h.broadPhase) || !validCollisionMode(h.collisionMode) || !validBoundary(h.boundary)){
+        error = "snapshot truncado ou corrompido";
+        return nullptr;
+    }
+
+    std::mt19937_64 rng;
+    std::istringstream rngText(std::string(bytes + h.rngOffset, h.rngBytes));
+    rngText >> rng;
+    if(!rngText){
+        error = "estado do gerador inválido";
+        return nullptr;
+    }
+
+    // Pede ao kernel para começar a ler as particulas enquanto o World é montado.
+    char* particleBase = static_cast<char*>(base) + h.particlesOffset;
+    ::madvise(particleBase, streamCount * h.particleStride, MADV_WILLNEED);
+    double* streams[ParticleArrays::STREAMS + 1] = {};
+    for(size_t s = 0; s < streamCount; ++s){
+        streams[s] = reinterpret_cast<double*>(particleBase + s * h.particleStride);
+    }
+    const size_t capacity = h.particleStride / sizeof(double);
+    ParticleArrays particles = ParticleArrays::adopt(std::move(mapping), streams[0], streams[1], streams[2], streams[3],
+                                                     streams[4], h.particleCount, capacity);
+
+    const ponto2D* segPoints = reinterpret_cast<const ponto2D*>(bytes + h.segsOffset);
+    std::vector<ponto2D> segs(segPoints, segPoints + h.segPointCount);
+
+    std::unique_ptr<World> world(new World{h.xMin, h.xMax, h.yMin, h.yMax, h.speed});
+    world->setBroadPhase(static_cast<BroadPhase>(h.broadPhase));
+    world->setCollisionMode(static_cast<CollisionMode>(h.collisionMode));
+    world->setBoundary(static_cast<Boundary>(h.boundary));
+    world->setParticleRadius(h.radius);
+    world->setParticleLifetime(h.particleLifetime);
+    world->restore(segs, std::move(particles), h.time);
+    // Sem reserve: os arrays continuam os mapeados e só são copiados se o pool passar deles.
+    world->particleCapacity = h.particleCapacity;
+    world->emitters.resize(h.emitterCount);
+    std::memcpy(world->emitters.data(), bytes + h.emittersOffset, h.emitterCount * sizeof(Emitter));
+    const uint8_t* absorbing = reinterpret_cast<const uint8_t*>(bytes + h.absorbingOffset);
+    for(size_t seg = 0; seg < absorbingBytes; ++seg){
+        if(absorbing[seg]){
+            world->setSegmentAbsorbing(static_cast<uint32_t>(seg), true);
+        }
+    }
+    world->seed = h.seed;
+    world->rng = rng;
+    world->stepCount = h.stepCount;
+    return world;
+}
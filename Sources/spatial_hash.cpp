@@ -0,0 +1,85 @@
+#include "../Libraries/spatial_hash.h"
+#include <cstring>
+
+ParticleHash::ParticleHash(): xMin{0.0}, yMin{0.0}, cellSize{1.0}, cols{1}, rows{1} {}
+
+// Tamanho da célula para n particulas: cerca de duas células por particula (menos
+// candidatas por consulta sem inflar cellStart), mas nunca menor que a distância de interação.
+static double cellSizeFor(size_t n, double minCellSize, double width, double height){
+    return std::max(minCellSize, std::sqrt(width * height / (2.0 * std::max<size_t>(n, 1))));
+}
+
+void ParticleHash::reserve(size_t n, double xMin, double xMax, double yMin, double yMax){
+    keys.reserve(n);
+    hx.reserve(n); hy.reserve(n); hdx.reserve(n); hdy.reserve(n);
+    hlife.reserve(n); hids.reserve(n);
+    // Com minCellSize = 0 e o maior n a grade tem o máximo de células.
+    const double width = std::max(xMax - xMin, 1e-9);
+    const double height = std::max(yMax - yMin, 1e-9);
+    const double size = cellSizeFor(n, 0.0, width, height);
+    const int64_t maxCols = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(width / size)));
+    const int64_t maxRows = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(height / size)));
+    cellStart.reserve(static_cast<size_t>(maxCols * maxRows) + 1);
+}
+
+void ParticleHash::build(double* x, double* y, double* dx, double* dy, double* life, uint32_t* ids, size_t n,
+                         double minCellSize, double xMin, double xMax, double yMin, double yMax){
+    this->xMin = xMin;
+    this->yMin = yMin;
+
+    const double width = std::max(xMax - xMin, 1e-9);
+    const double height = std::max(yMax - yMin, 1e-9);
+    cellSize = cellSizeFor(n, minCellSize, width, height);
+    cols = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(width / cellSize)));
+    rows = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(height / cellSize)));
+
+    // Contagem...
+    keys.resize(n);
+    cellStart.assign(static_cast<size_t>(cols * rows) + 1, 0);
+    for(size_t i = 0; i < n; ++i){
+        uint32_t key = static_cast<uint32_t>(cellY(y[i]) * cols + cellX(x[i]));
+        keys[i] = key;
+        ++cellStart[key + 1];
+    }
+    // ...prefixo...
+    for(size_t c = 1; c < cellStart.size(); ++c){
+        cellStart[c] += cellStart[c - 1];
+    }
+    // ...e espalhamento (estável: a ordem dentro de cada célula se mantém).
+    hx.resize(n); hy.resize(n); hdx.resize(n); hdy.resize(n);
+    if(life){
+        hlife.resize(n);
+    }
+    if(ids){
+        hids.resize(n);
+    }
+    for(size_t i = 0; i < n; ++i){
+        uint32_t e = cellStart[keys[i]]++;
+        hx[e] = x[i]; hy[e] = y[i];
+        hdx[e] = dx[i]; hdy[e] = dy[i];
+        if(life){
+            hlife[e] = life[i];
+        }
+        if(ids){
+            hids[e] = ids[i];
+        }
+    }
+    // O espalhamento avançou cada início até o início da próxima célula: desfaz o deslocamento.
+    for(size_t c = cellStart.size() - 1; c > 0; --c){
+        cellStart[c] = cellStart[c - 1];
+    }
+    cellStart[0] = 0;
+
+    if(n > 0){
+        std::memcpy(x, hx.data(), n * sizeof(double));
+        std::memcpy(y, hy.data(), n * sizeof(double));
+        std::memcpy(dx, hdx.data(), n * sizeof(double));
+        std::memcpy(dy, hdy.data(), n * sizeof(double));
+        if(life){
+            std::memcpy(life, hlife.data(), n * sizeof(double));
+        }
+        if(ids){
+            std::memcpy(ids, hids.data(), n * sizeof(uint32_t));
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include "../Libraries/threadpool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads):
+    fn{nullptr}, ctx{nullptr}, total{0}, chunk{1}, nextChunk{0}, busy{0}, generation{0}, stopping{false} {
+    if(threads == 0){
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // A thread que chama parallelFor é o worker 0.
+    for(unsigned w = 1; w < threads; ++w){
+        workers.emplace_back(&ThreadPool::workerLoop, this, w);
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(std::thread& t : workers){
+        t.join();
+    }
+}
+
+unsigned ThreadPool::size() const{
+    return static_cast<unsigned>(workers.size()) + 1;
+}
+
+// Cada worker pega o próximo bloco livre até acabarem (balanceamento dinâmico).
+void ThreadPool::runChunks(unsigned worker){
+    for(;;){
+        size_t c = nextChunk.fetch_add(1, std::memory_order_relaxed);
+        size_t begin = c * chunk;
+        if(begin >= total){
+            return;
+        }
+        fn(ctx, begin, std::min(begin + chunk, total), worker);
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker){
+    unsigned long seen = 0;
+    for(;;){
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]{ return stopping || generation != seen; });
+            if(stopping){
+                return;
+            }
+            seen = generation;
+        }
+
+        runChunks(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(--busy == 0){
+            done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::run(size_t n, size_t chunk, ChunkFn fn, void* ctx){
+    if(n == 0){
+        return;
+    }
+    if(workers.empty() || n <= chunk){
+        fn(ctx, 0, n, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->fn = fn;
+        this->ctx = ctx;
+        this->total = n;
+        this->chunk = chunk;
+        this->nextChunk.store(0, std::memory_order_relaxed);
+        this->busy = static_cast<unsigned>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    runChunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]{ return busy == 0; });
+}
@@ -0,0 +1,902 @@
+#include "../Libraries/world.h"
+#include "../Libraries/collision.h"
+#include "../Libraries/intersect_batch.h"
+#include "../Libraries/profiler.h"
+#include "../Libraries/replay.h"
+#include "../Libraries/scene.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+
+World::World(float xMin, float xMax, float yMin, float yMax, float speed):
+    xMin{xMin}, xMax{xMax}, yMin{yMin}, yMax{yMax}, speed{speed},
+    broadPhase{BroadPhase::Linear}, collisionMode{CollisionMode::Discrete},
+    boundary{Boundary::Reflect}, limitsFn{&World::applyLimits<ReflectBoundary>}, accelDirty{true}, segsRevision{0}, radius{0.0},
+    particleCapacity{0}, particleLifetime{ParticleArrays::IMMORTAL}, despawning{false}, time{0.0}, collisionLog{nullptr},
+    seed{std::random_device{}()}, rng{seed}, stepCount{0}, recorder{nullptr}, scratch(1) {
+    reserveScratch();
+    this->reset();
+}
+
+// Os buffers de cada worker já nascem do tamanho de um bloco inteiro do passo. A caixa
+// de uma particula em um passo cabe em 2x2 células enquanto speed*dt for menor que uma
+// célula, então candidates nunca passa de 4 células cheias (nem do total da grade).
+void World::reserveScratch(){
+    const size_t candidates = std::min(4 * grid.get_maxCellCount(), grid.get_itemCount());
+    for(StepScratch& s : scratch){
+        s.hitMask.reserve(STEP_CHUNK);
+        s.partners.reserve(STEP_CHUNK);
+        s.candidates.reserve(candidates);
+    }
+}
+
+// Gera um sentido aleatório que a particula seguirá ao nascer
+vec2 World::randomDirection(){
+
+    // Angulo entre 0 e 2PI
+    double angle = std::uniform_real_distribution<double>(0.0, 2.0 * M_PI)(rng);
+
+    return vec2{std::cos(angle), std::sin(angle)};
+}
+
+void World::randomSegs(int count){
+    if(recorder) recorder->randomSegs(stepCount, count);
+
+    std::uniform_real_distribution<> distrib_x(xMin, xMax);
+    std::uniform_real_distribution<> distrib_y(yMin, yMax);
+    
+    for(int i = 0; i < 2 * count; ++i){
+        double x = distrib_x(rng);
+        double y = distrib_y(rng);
+        segs.emplace_back(ponto2D(x, y));    
+    }
+    segTable.rebuild(segs);
+    accelDirty = true;
+    ++segsRevision;
+
+}
+
+void World::loadSegments(const SceneSegments& scene){
+    if(recorder) recorder->loadSegments(stepCount, scene.points);
+    // Um ponto sobrando de cliques forma segmento com o primeiro da cena; sem ele, a
+    // normal e a caixa da cena são usadas como estão.
+    const bool aligned = segs.size() % 2 == 0;
+    segs.insert(segs.end(), scene.points.begin(), scene.points.end());
+    if(aligned){
+        segTable.reserve(segTable.size() + scene.size());
+        for(size_t s = 0; s < scene.size(); ++s){
+            segTable.add(SegmentTable::makeEntry(scene.points[2 * s], scene.points[2 * s + 1], scene.normals[s], scene.boxes[s]));
+        }
+    }else{
+        segTable.rebuild(segs);
+    }
+    accelDirty = true;
+    ++segsRevision;
+}
+
+void World::addSegmentPoint(const ponto2D& p){
+    if(recorder) recorder->addSegmentPoint(stepCount, p);
+    segs.emplace_back(p);
+    if(segs.size() % 2 == 0){
+        segTable.add(segs[segs.size() - 2], segs[segs.size() - 1]);
+    }
+    accelDirty = true;
+    ++segsRevision;
+}
+
+void World::setBoundary(Boundary b){
+    if(recorder) recorder->setBoundary(stepCount, b);
+    boundary = b;
+    switch(b){
+        case Boundary::Reflect:  limitsFn = &World::applyLimits<ReflectBoundary>; break;
+        case Boundary::Periodic: limitsFn = &World::applyLimits<PeriodicBoundary>; break;
+        case Boundary::Absorb:   limitsFn = &World::applyLimits<AbsorbBoundary>; break;
+        case Boundary::Clamp:    limitsFn = &World::applyLimits<ClampBoundary>; break;
+    }
+    if(b == Boundary::Absorb){
+        particles.enableLife();
+        despawning = true;
+    }
+}
+
+Boundary World::getBoundary() const{
+    return this->boundary;
+}
+
+void World::setBroadPhase(BroadPhase bp){
+    if(recorder) recorder->setBroadPhase(stepCount, bp);
+    broadPhase = bp;
+    accelDirty = true;
+}
+
+void World::setParticleRadius(double radius){
+    if(recorder) recorder->setRadius(stepCount, radius);
+    this->radius = std::max(radius, 0.0);
+}
+
+double World::getParticleRadius() const{
+    return this->radius;
+}
+
+void World::setCollisionLog(CollisionLog* log){
+    collisionLog = log;
+}
+
+CollisionLog* World::getCollisionLog() const{
+    return this->collisionLog;
+}
+
+void World::setCollisionMode(CollisionMode mode){
+    if(recorder) recorder->setCollisionMode(stepCount, mode);
+    collisionMode = mode;
+}
+
+CollisionMode World::getCollisionMode() const{
+    return this->collisionMode;
+}
+
+BroadPhase World::getBroadPhase() const{
+    return this->broadPhase;
+}
+
+const SegmentGrid& World::getGrid() const{
+    return this->grid;
+}
+
+const SegmentBVH& World::getBvh() const{
+    return this->bvh;
+}
+
+ParticleHandle World::pushParticle(const ponto2D& p, const vec2& dir, double life){
+    if(particleCapacity != 0 && particles.size() >= particleCapacity){
+        ++poolStats.dropped;
+        return ParticleHandleTable::INVALID;
+    }
+    // A direção é guardada unitária; as reflexões preservam a norma,
+    // então moveParticles não precisa normalizar a cada passo.
+    vec2 d = dir.normalized();
+    particles.push(p.x, p.y, d.x, d.y, life);
+    ++poolStats.spawned;
+    if(life != ParticleArrays::IMMORTAL){
+        despawning = true;
+    }
+    return handles.create();
+}
+
+ParticleHandle World::addParticle(const ponto2D& p, const vec2& dir){
+    if(recorder) recorder->addParticle(stepCount, p, dir);
+    return pushParticle(p, dir, particleLifetime);
+}
+
+ParticleHandle World::addParticle(const ponto2D& p){
+    if(recorder) recorder->addParticle(stepCount, p);
+    return pushParticle(p, randomDirection(), particleLifetime);
+}
+
+uint32_t World::findParticle(ParticleHandle h) const{
+    return handles.slotOf(h);
+}
+
+ParticleHandle World::particleHandle(size_t i) const{
+    return handles.handleAt(static_cast<uint32_t>(i));
+}
+
+void World::setParticleCapacity(size_t capacity){
+    if(recorder) recorder->setParticleCapacity(stepCount, capacity);
+    particleCapacity = capacity;
+    // Tudo o que o passo dimensiona pelo número de particulas fica reservado aqui, para
+    // o pool cheio não alocar nada durante a simulação.
+    particles.reserve(capacity);
+    handles.reserve(capacity);
+    particleHash.reserve(capacity, xMin, xMax, yMin, yMax);
+}
+
+size_t World::getParticleCapacity() const{
+    return this->particleCapacity;
+}
+
+void World::setParticleLifetime(double seconds){
+    if(recorder) recorder->setParticleLifetime(stepCount, seconds);
+    particleLifetime = seconds > 0.0 ? seconds : ParticleArrays::IMMORTAL;
+    if(particleLifetime != ParticleArrays::IMMORTAL){
+        particles.enableLife();
+    }
+}
+
+double World::getParticleLifetime() const{
+    return this->particleLifetime;
+}
+
+void World::addEmitter(const Emitter& emitter){
+    if(recorder) recorder->addEmitter(stepCount, emitter);
+    emitters.push_back(emitter);
+    if(emitter.lifetime != ParticleArrays::IMMORTAL){
+        particles.enableLife();
+    }
+}
+
+const std::vector<Emitter>& World::getEmitters() const{
+    return this->emitters;
+}
+
+void World::setSegmentAbsorbing(uint32_t seg, bool absorbing){
+    if(seg >= segTable.size()){
+        return;
+    }
+    if(recorder) recorder->setSegmentAbsorbing(stepCount, seg, absorbing);
+    segTable.setAbsorbing(seg, absorbing);
+    if(absorbing){
+        particles.enableLife();
+        despawning = true;
+    }
+}
+
+const ParticlePoolStats& World::getPoolStats() const{
+    return this->poolStats;
+}
+
+// Cada emissor acumula rate * dt e cria a parte inteira; a fração fica para o próximo passo.
+// Com o pool cheio as que faltam são só contadas, sem sortear direção.
+void World::emitParticles(double dt){
+    for(Emitter& e : emitters){
+        e.pending += e.rate * dt;
+        const double due = std::floor(e.pending);
+        e.pending -= due;
+        const uint64_t count = static_cast<uint64_t>(due);
+        for(uint64_t k = 0; k < count; ++k){
+            if(particleCapacity != 0 && particles.size() >= particleCapacity){
+                poolStats.dropped += count - k;
+                break;
+            }
+            pushParticle(e.position, randomDirection(), e.lifetime);
+        }
+    }
+}
+
+// Tira do World as particulas com vida <= 0, só no intervalo que os blocos anotaram.
+// Em ordem decrescente de índice, a última (que swapRemove move para o buraco) já foi
+// visitada ou está acima do intervalo, então está viva; o resultado não depende de como
+// os blocos foram divididos entre as threads.
+void World::removeExpired(){
+    size_t first = SIZE_MAX;
+    size_t last = 0;
+    for(StepScratch& s : scratch){
+        first = std::min(first, s.expiredFirst);
+        last = std::max(last, s.expiredLast);
+        s.expiredFirst = SIZE_MAX;
+        s.expiredLast = 0;
+    }
+    if(first > last){
+        return;
+    }
+    const double* life = particles.life();
+    for(size_t i = last + 1; i-- > first;){
+        if(life[i] <= 0.0){
+            particles.swapRemove(i);
+            handles.swapRemove(static_cast<uint32_t>(i));
+            ++poolStats.despawned;
+        }
+    }
+}
+
+void World::reset(){
+    if(recorder) recorder->reset(stepCount);
+    segs.clear();
+    segTable.clear();
+    particles.clear();
+    handles.clear();
+    emitters.clear();
+    despawning = boundary == Boundary::Absorb;
+    if(despawning || particleLifetime != ParticleArrays::IMMORTAL){
+        particles.enableLife();
+    }
+    time = 0.0;
+    accelDirty = true;
+    ++segsRevision;
+    // Sempre nasce na origem e vai ter sentido 45 Graus no 1º Quadrante.
+    pushParticle(ponto2D{0.0, 0.0}, vec2{(std::cos(M_PI/4)), (std::sin(M_PI/4))}, ParticleArrays::IMMORTAL);
+}
+
+void World::restore(const std::vector<ponto2D>& segs, ParticleArrays&& particles, double time){
+    this->segs = segs;
+    segTable.clear();
+    segTable.rebuild(this->segs);
+    this->particles = std::move(particles);
+    handles.assign(this->particles.size());
+    const double* life = this->particles.life();
+    despawning = boundary == Boundary::Absorb
+                 || (life && std::any_of(life, life + this->particles.size(),
+                                         [](double l){ return l != ParticleArrays::IMMORTAL; }));
+    if(despawning || particleLifetime != ParticleArrays::IMMORTAL){
+        this->particles.enableLife();
+    }
+    this->time = time;
+    accelDirty = true;
+    ++segsRevision;
+}
+
+void World::setSeed(uint64_t seed){
+    this->seed = seed;
+    rng.seed(seed);
+}
+
+uint64_t World::get_seed() const{
+    return this->seed;
+}
+
+unsigned long World::get_stepCount() const{
+    return this->stepCount;
+}
+
+void World::setRecorder(SimulationRecorder* recorder){
+    this->recorder = recorder;
+}
+
+SimulationRecorder* World::getRecorder() const{
+    return this->recorder;
+}
+
+// Hash de 64 bits sobre os bits exatos de particulas e segmentos (FNV-1a por palavra de
+// 64 bits em vez de por byte): qualquer diferença de arredondamento muda o valor.
+uint64_t World::stateHash() const{
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&](const double* v, size_t n){
+        for(size_t i = 0; i < n; ++i){
+            uint64_t bits;
+            std::memcpy(&bits, &v[i], sizeof(bits));
+            h = (h ^ bits) * prime;
+        }
+    };
+    const size_t n = particles.size();
+    h = (h ^ n) * prime;
+    mix(particles.x(), n);
+    mix(particles.y(), n);
+    mix(particles.dx(), n);
+    mix(particles.dy(), n);
+    // Só as vidas finitas entram: sem despawn o hash é o mesmo de antes delas existirem.
+    if(despawning){
+        const double* life = particles.life();
+        for(size_t i = 0; i < n; ++i){
+            if(life[i] != ParticleArrays::IMMORTAL){
+                mix(&life[i], 1);
+            }
+        }
+    }
+    h = (h ^ segs.size()) * prime;
+    for(const ponto2D& p : segs){
+        mix(&p.x, 1);
+        mix(&p.y, 1);
+    }
+    return h;
+}
+
+bool World::pointIntersectsSegment(const ponto2D& point, double dx, double dy, const SegmentEntry& seg, double dt) const {
+    ponto2D projectedPoint;
+    projectedPoint.x = point.x + dx * (speed * dt);
+    projectedPoint.y = point.y + dy * (speed * dt);
+    return segmentIntersect(point, projectedPoint, seg);
+}
+
+// É chamada a cada passo para verificar inteseção da particula com algum segmento.
+// Os testes de todas as particulas contra o segmento rodam em lote (intersectBatch, AVX2
+// quando disponível); as reflexões são aplicadas depois, só nas particulas atingidas.
+void World::checkIntersect(uint32_t seg, size_t begin, size_t end, double dt, StepScratch& s){
+    const SegmentEntry& e = segTable[seg];
+    const vec2 normal = e.normal;
+    const bool absorbs = segTable.absorbs(seg);
+    double* x = particles.x();
+    double* y = particles.y();
+    double* dx = particles.dx();
+    double* dy = particles.dy();
+    double* life = particles.life();
+    const size_t n = end - begin;
+
+    s.hitMask.resize(n);
+    intersectBatch(x + begin, y + begin, dx + begin, dy + begin, n, speed * dt, e.a, e.b, s.hitMask.data());
+
+    for (size_t k = 0; k < n; ++k) {
+        if (s.hitMask[k]) {
+            size_t i = begin + k;
+            if (life && life[i] <= 0.0) {
+                continue; // Já absorvida por outro segmento ou pelo limite neste passo
+            }
+            publishCollision(i, seg, time, x[i], y[i], normal);
+            if (absorbs) {
+                life[i] = 0.0;
+                continue;
+            }
+            vec2 newDirection = reflect(vec2{dx[i], dy[i]}, normal);
+
+            dx[i] = newDirection.x;
+            dy[i] = newDirection.y;
+        }
+    }
+}
+
+// Mesma regra do checkIntersect, mas cada particula só testa os segmentos das células
+// que a caixa [p - |d|*speed*dt, p + |d|*speed*dt] toca. A caixa cobre o caminho para
+// qualquer direção, então continua válida depois que uma reflexão muda dx/dy no meio dos
+// testes (reflexões preservam |d|).
+void World::checkIntersectGrid(size_t begin, size_t end, double dt, StepScratch& s){
+    double* x = particles.x();
+    double* y = particles.y();
+    double* dx = particles.dx();
+    double* dy = particles.dy();
+    double* life = particles.life();
+    const double len = std::abs(speed * dt);
+
+    for (size_t i = begin; i < end; ++i) {
+        const double reach = len * std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+        grid.query(x[i] - reach, y[i] - reach, x[i] + reach, y[i] + reach, s.candidates);
+        for (uint32_t c : s.candidates) {
+            const SegmentEntry& e = segTable[c];
+            if (pointIntersectsSegment(ponto2D{x[i], y[i]}, dx[i], dy[i], e, dt)) {
+                if (life && life[i] <= 0.0) {
+                    break; // Já saiu pelo limite neste passo
+                }
+                const vec2& normal = e.normal;
+                publishCollision(i, c, time, x[i], y[i], normal);
+                if (segTable.absorbs(c)) {
+                    life[i] = 0.0;
+                    break;
+                }
+                vec2 newDirection = reflect(vec2{dx[i], dy[i]}, normal);
+
+                dx[i] = newDirection.x;
+                dy[i] = newDirection.y;
+            }
+        }
+    }
+}
+
+// Cada particula consulta a BVH com o seu caminho p --> p + dir*speed*dt e reflete
+// apenas no segmento atingido primeiro ao longo dele.
+void World::checkIntersectBvh(size_t begin, size_t end, double dt){
+    double* x = particles.x();
+    double* y = particles.y();
+    double* dx = particles.dx();
+    double* dy = particles.dy();
+    double* life = particles.life();
+
+    for (size_t i = begin; i < end; ++i) {
+        ponto2D point{x[i], y[i]};
+        ponto2D projectedPoint{x[i] + dx[i] * (speed * dt), y[i] + dy[i] * (speed * dt)};
+        double t;
+        uint32_t s = bvh.nearestHit(point, projectedPoint, t);
+        if (s != SegmentBVH::NO_HIT) {
+            if (life && life[i] <= 0.0) {
+                continue; // Já saiu pelo limite neste passo
+            }
+            const vec2& normal = segTable[s].normal;
+            publishCollision(i, s, time, x[i], y[i], normal);
+            if (segTable.absorbs(s)) {
+                life[i] = 0.0;
+                continue;
+            }
+            vec2 newDirection = reflect(vec2{dx[i], dy[i]}, normal);
+
+            dx[i] = newDirection.x;
+            dy[i] = newDirection.y;
+        }
+    }
+}
+
+// Reconstrói a estrutura da broad-phase atual depois que segs mudou.
+void World::rebuildAccel(){
+    if(broadPhase == BroadPhase::Grid){
+        grid.build(segs, xMin, xMax, yMin, yMax);
+        reserveScratch();
+    }else if(broadPhase == BroadPhase::Bvh){
+        bvh.build(segs);
+    }
+    accelDirty = false;
+}
+
+// Aplica a política de limites a cada particula; os limites vão para variáveis locais
+// para o laço não reler os membros a cada iteração.
+template<typename Policy>
+void World::applyLimits(size_t begin, size_t end){
+    double* x = particles.x();
+    double* y = particles.y();
+    double* dx = particles.dx();
+    double* dy = particles.dy();
+    const double x0 = xMin, x1 = xMax, y0 = yMin, y1 = yMax;
+
+    if constexpr (Policy::RETIRES) {
+        double* life = particles.life();
+        for (size_t i = begin; i < end; ++i) {
+            const bool out = Policy::apply(x[i], y[i], dx[i], dy[i], x0, x1, y0, y1);
+            life[i] = out ? 0.0 : life[i];
+        }
+    } else {
+        for (size_t i = begin; i < end; ++i) {
+            Policy::apply(x[i], y[i], dx[i], dy[i], x0, x1, y0, y1);
+        }
+    }
+}
+
+// Check a colisão com os limites da janela gráfica
+void World::intersectWithLimits(size_t begin, size_t end) {
+    (this->*limitsFn)(begin, end);
+}
+
+// Faz todas as particulas andarem seguindo a direção daquela particula.
+void World::moveParticles(size_t begin, size_t end, double dt){
+    double* x = particles.x();
+    double* y = particles.y();
+    const double* dx = particles.dx();
+    const double* dy = particles.dy();
+    const double d = speed * dt;
+
+    for(size_t i = begin; i < end; ++i){
+        x[i] += dx[i] * d;
+        y[i] += dy[i] * d;
+    }
+}
+
+// Segmento atingido primeiro pelo caminho p --> q (SegmentBVH::NO_HIT se nenhum),
+// usando a broad-phase atual para escolher os candidatos.
+uint32_t World::nearestSegmentHit(const ponto2D& p, const ponto2D& q, double& t, uint32_t exclude, StepScratch& s) const{
+    if(broadPhase == BroadPhase::Bvh){
+        return bvh.nearestHit(p, q, t, exclude);
+    }
+
+    uint32_t best = SegmentBVH::NO_HIT;
+    double bestT = 1.0;
+    auto test = [&](uint32_t c){
+        if(c == exclude) return;
+        const SegmentEntry& e = segTable[c];
+        if(segmentIntersect(p, q, e)){
+            double th = intersectionTime(p, q, e.a, e.b);
+            if(best == SegmentBVH::NO_HIT || th < bestT || (th == bestT && c < best)){
+                best = c;
+                bestT = th;
+            }
+        }
+    };
+
+    if(broadPhase == BroadPhase::Grid){
+        grid.query(std::min(p.x, q.x), std::min(p.y, q.y), std::max(p.x, q.x), std::max(p.y, q.y), s.candidates);
+        for(uint32_t c : s.candidates){
+            test(c);
+        }
+    }else{
+        for(uint32_t c = 0; c < segTable.size(); ++c){
+            test(c);
+        }
+    }
+
+    t = bestT;
+    return best;
+}
+
+// Detecção contínua: em vez de mover e depois testar, cada particula calcula o primeiro
+// contato (segmento ou limite) ao longo do caminho restante, avança até ele, reflete e
+// continua com o que sobrou do passo. Assim velocidades altas não atravessam segmentos.
+void World::advanceContinuous(size_t begin, size_t end, double dt, StepScratch& s){
+    double* x = particles.x();
+    double* y = particles.y();
+    double* dx = particles.dx();
+    double* dy = particles.dy();
+    double* life = particles.life();
+    const bool hasSegs = !segTable.empty();
+
+    const double total = speed * dt;
+    for(size_t i = begin; i < end; ++i){
+        double remaining = total; // distância que falta percorrer neste passo
+        uint32_t lastSeg = SegmentBVH::NO_HIT;
+
+        for(int bounce = 0; bounce < MAX_BOUNCES && remaining > 0.0; ++bounce){
+            ponto2D p{x[i], y[i]};
+            ponto2D q{x[i] + dx[i] * remaining, y[i] + dy[i] * remaining};
+
+            // Limites: fração do caminho até a parede para a qual a particula se move.
+            double tWall = 2.0;
+            int wallAxis = -1;
+            if(dx[i] > 0.0 && q.x > xMax){ tWall = (xMax - p.x) / (q.x - p.x); wallAxis = 0; }
+            if(dx[i] < 0.0 && q.x < xMin){ tWall = (xMin - p.x) / (q.x - p.x); wallAxis = 0; }
+            if(dy[i] > 0.0 && q.y > yMax){ double ty = (yMax - p.y) / (q.y - p.y); if(ty < tWall){ tWall = ty; wallAxis = 1; } }
+            if(dy[i] < 0.0 && q.y < yMin){ double ty = (yMin - p.y) / (q.y - p.y); if(ty < tWall){ tWall = ty; wallAxis = 1; } }
+            tWall = std::max(tWall, 0.0);
+
+            double tSeg = 2.0;
+            uint32_t seg = SegmentBVH::NO_HIT;
+            if(hasSegs){
+                seg = nearestSegmentHit(p, q, tSeg, lastSeg, s);
+                if(seg == SegmentBVH::NO_HIT) tSeg = 2.0;
+            }
+
+            if(wallAxis < 0 && seg == SegmentBVH::NO_HIT){
+                x[i] = q.x;
+                y[i] = q.y;
+                break;
+            }
+
+            if(seg != SegmentBVH::NO_HIT && tSeg <= tWall){
+                x[i] = p.x + (q.x - p.x) * tSeg;
+                y[i] = p.y + (q.y - p.y) * tSeg;
+                remaining *= (1.0 - tSeg);
+
+                const vec2& normal = segTable[seg].normal;
+                publishCollision(i, seg, time + dt * (1.0 - remaining / total), x[i], y[i], normal);
+                if(segTable.absorbs(seg)){
+                    life[i] = 0.0;
+                    break;
+                }
+                // Afasta o ponto de contato um pouco para o lado de onde veio, para o
+                // arredondamento não deixá-lo do outro lado do segmento.
+                double side = (dx[i] * normal.x + dy[i] * normal.y) > 0.0 ? -1.0 : 1.0;
+                x[i] += side * normal.x * 1e-9;
+                y[i] += side * normal.y * 1e-9;
+
+                vec2 newDirection = reflect(vec2{dx[i], dy[i]}, normal);
+                dx[i] = newDirection.x;
+                dy[i] = newDirection.y;
+                lastSeg = seg;
+            }else{
+                x[i] = p.x + (q.x - p.x) * tWall;
+                y[i] = p.y + (q.y - p.y) * tWall;
+                remaining *= (1.0 - tWall);
+                // Na parede a particula fica exatamente no limite e a política decide o resto.
+                double& pos = wallAxis == 0 ? x[i] : y[i];
+                double& dir = wallAxis == 0 ? dx[i] : dy[i];
+                const double lo = wallAxis == 0 ? xMin : yMin;
+                const double hi = wallAxis == 0 ? xMax : yMax;
+                const bool high = dir > 0.0;
+                pos = high ? hi : lo;
+                switch(boundary){
+                    case Boundary::Reflect:
+                        dir = -dir;
+                        break;
+                    case Boundary::Periodic:
+                        pos = high ? lo : hi; // continua do lado oposto, mesma direção
+                        break;
+                    case Boundary::Clamp:
+                        dir = 0.0; // desliza ao longo da parede com o que sobrou
+                        break;
+                    case Boundary::Absorb:
+                        dx[i] = 0.0;
+                        dy[i] = 0.0;
+                        life[i] = 0.0;
+                        remaining = 0.0;
+                        break;
+                }
+                lastSeg = SegmentBVH::NO_HIT;
+            }
+        }
+    }
+}
+
+// A particula i escolhe, entre as vizinhas que a tocam e se aproximam dela, a de maior
+// velocidade de aproximação ao longo da normal (empate: menor índice). Lê só a cópia do
+// hash (estado do início do passo), então vale para qualquer i enquanto outros blocos
+// já movem as suas particulas.
+uint32_t World::choosePartner(uint32_t i) const{
+    const double px = particleHash.get_x(i);
+    const double py = particleHash.get_y(i);
+    const double vx = particleHash.get_dx(i);
+    const double vy = particleHash.get_dy(i);
+    const double minDist2 = 4.0 * radius * radius;
+    uint32_t best = NO_PARTNER;
+    double bestClosing = 0.0;
+    particleHash.forEachNeighbor(px, py, [&](uint32_t j, double qx, double qy, double ux, double uy){
+        if(j == i) return;
+        double nx = px - qx;
+        double ny = py - qy;
+        double dist2 = nx * nx + ny * ny;
+        if(dist2 >= minDist2 || dist2 == 0.0) return;
+        // Particulas sobrepostas que já se afastam não são puxadas de volta.
+        double approach = (vx - ux) * nx + (vy - uy) * ny;
+        if(approach >= 0.0) return;
+        double closing = approach * approach / dist2;
+        if(closing > bestClosing){
+            bestClosing = closing;
+            best = j;
+        }
+    });
+    return best;
+}
+
+// Colisão elástica entre particulas de massas iguais: só pares em que cada uma escolheu
+// a outra trocam as componentes normais da velocidade. As escolhas são feitas aqui, bloco
+// a bloco, em vez de numa passada anterior sobre todas as particulas: a escolha de uma
+// vizinha de outro bloco é refeita (o hash ordena por célula, então quase todas caem no
+// mesmo bloco). Os dois lados calculam a troca com os mesmos valores do início do passo,
+// então momento e energia se conservam exatamente, e cada particula só escreve na
+// própria velocidade (blocos não disputam memória).
+void World::collideParticles(size_t begin, size_t end, StepScratch& s){
+    const double* x = particles.x();
+    const double* y = particles.y();
+    double* dx = particles.dx();
+    double* dy = particles.dy();
+
+    s.partners.resize(end - begin);
+    for(size_t i = begin; i < end; ++i){
+        s.partners[i - begin] = choosePartner(static_cast<uint32_t>(i));
+    }
+    for(size_t i = begin; i < end; ++i){
+        const uint32_t j = s.partners[i - begin];
+        if(j == NO_PARTNER) continue;
+        const uint32_t back = j >= begin && j < end ? s.partners[j - begin] : choosePartner(j);
+        if(back != i) continue;
+        double nx = x[i] - particleHash.get_x(j);
+        double ny = y[i] - particleHash.get_y(j);
+        double k = ((dx[i] - particleHash.get_dx(j)) * nx + (dy[i] - particleHash.get_dy(j)) * ny) / (nx * nx + ny * ny);
+        dx[i] -= k * nx;
+        dy[i] -= k * ny;
+    }
+}
+
+// Passo completo de um bloco de particulas. Cada particula só depende dela mesma, dos
+// segmentos e do hash das particulas (que não muda durante o passo), então blocos
+// podem rodar em paralelo.
+void World::stepRange(size_t begin, size_t end, double dt, StepScratch& s){
+    if(radius > 0.0){
+        PROFILE_SCOPE(ProfilePhase::ParticleCollision);
+        collideParticles(begin, end, s);
+    }
+
+    if(collisionMode == CollisionMode::Continuous){
+        PROFILE_SCOPE(ProfilePhase::Segments);
+        advanceContinuous(begin, end, dt, s);
+    }else{
+        {
+            PROFILE_SCOPE(ProfilePhase::Move);
+            moveParticles(begin, end, dt);
+        }
+        {
+            PROFILE_SCOPE(ProfilePhase::Limits);
+            intersectWithLimits(begin, end);
+        }
+
+        if(!segTable.empty()){
+            PROFILE_SCOPE(ProfilePhase::Segments);
+            if(broadPhase == BroadPhase::Grid){
+                checkIntersectGrid(begin, end, dt, s);
+            }else if(broadPhase == BroadPhase::Bvh){
+                checkIntersectBvh(begin, end, dt);
+            }else{
+                for(uint32_t seg = 0; seg < segTable.size(); ++seg){
+                    checkIntersect(seg, begin, end, dt, s);
+                }
+            }
+        }
+    }
+
+    if(despawning){
+        ageParticles(begin, end, dt, s);
+    }
+}
+
+// Desconta dt do tempo de vida e anota onde estão as particulas que expiraram ou foram
+// absorvidas neste passo; removeExpired as tira depois que todos os blocos terminarem,
+// porque swapRemove mexe em particulas de outros blocos.
+void World::ageParticles(size_t begin, size_t end, double dt, StepScratch& s){
+    double* life = particles.life();
+    for(size_t i = begin; i < end; ++i){
+        life[i] -= dt;
+    }
+    for(size_t i = begin; i < end; ++i){
+        if(life[i] <= 0.0){
+            s.expiredFirst = std::min(s.expiredFirst, i);
+            s.expiredLast = std::max(s.expiredLast, i);
+        }
+    }
+}
+
+void World::step(double dt){
+    if(accelDirty){
+        rebuildAccel();
+    }
+    if(!emitters.empty()){
+        emitParticles(dt);
+    }
+
+    const size_t n = particles.size();
+    if(radius > 0.0){
+        PROFILE_SCOPE(ProfilePhase::ParticleHash);
+        // O hash guarda o estado do início do passo; é a única passada extra do passo.
+        particleHash.build(particles.x(), particles.y(), particles.dx(), particles.dy(),
+                           despawning ? particles.life() : nullptr, handles.ownerData(), n, 2.0 * radius,
+                           xMin, xMax, yMin, yMax);
+        handles.resync();
+    }
+
+    if(!pool){
+        for(size_t begin = 0; begin < n; begin += STEP_CHUNK){
+            stepRange(begin, std::min(begin + STEP_CHUNK, n), dt, scratch[0]);
+        }
+    }else{
+        auto chunkFn = [this, dt](size_t begin, size_t end, unsigned worker){
+            stepRange(begin, end, dt, scratch[worker]);
+        };
+        pool->parallelFor(n, STEP_CHUNK, chunkFn);
+    }
+    if(despawning){
+        removeExpired();
+    }
+    time += dt;
+    ++stepCount;
+    if(recorder && stepCount % recorder->get_hashInterval() == 0){
+        recorder->stateHash(stepCount, stateHash());
+    }
+}
+
+void World::setThreadCount(unsigned threads){
+    pool.reset();
+    if(threads != 1){
+        pool.reset(new ThreadPool(threads));
+    }
+    scratch.resize(getThreadCount());
+    reserveScratch();
+}
+
+unsigned World::getThreadCount() const{
+    return pool ? pool->size() : 1;
+}
+
+float World::get_xMin() const{
+    return this->xMin;
+}
+
+float World::get_xMax() const{
+    return this->xMax;
+}
+
+float World::get_yMin() const{
+    return this->yMin;
+}
+
+float World::get_yMax() const{
+    return this->yMax;
+}
+
+double World::get_time() const{
+    return this->time;
+}
+
+float World::get_speed() const{
+    return this->speed;
+}
+
+void World::setSpeed(float speed){
+    if(recorder) recorder->setSpeed(stepCount, speed);
+    this->speed = speed;
+}
+
+const std::vector<ponto2D>& World::getSegs() const{
+    return this->segs;
+}
+
+unsigned long World::getSegsRevision() const{
+    return this->segsRevision;
+}
+
+const SegmentTable& World::getSegmentTable() const{
+    return this->segTable;
+}
+
+const ParticleArrays& World::getParticles() const{
+    return this->particles;
+}
+
+void World::writePositions(float* dst) const{
+    const double* x = particles.x();
+    const double* y = particles.y();
+    const size_t n = particles.size();
+
+    for(size_t i = 0; i < n; ++i){
+        dst[2 * i] = static_cast<float>(x[i]);
+        dst[2 * i + 1] = static_cast<float>(y[i]);
+    }
+}
+
+void World::writeSegmentVertices(float* dst) const{
+    for(size_t i = 0; i < segs.size(); ++i){
+        dst[2 * i] = static_cast<float>(segs[i].x);
+        dst[2 * i + 1] = static_cast<float>(segs[i].y);
+    }
+}
@@ -0,0 +1,349 @@
+#include "Libraries/world.h"
+#include "Libraries/collision.h"
+#include "Libraries/vectors.h"
+#include "Libraries/vec.h"
+#include "Libraries/intersect_batch.h"
+#include "Libraries/scene.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmarks do núcleo da simulação, sem janela.
+// Uso: ParticlePhysics.bench [--out arquivo.json] [--filter texto] [--quick]
+// Cada caso roda algumas vezes para aquecer e depois é repetido até somar um tempo
+// mínimo; o resultado (mediana, p99, ns/op, itens/s) vai para a tela e para um JSON.
+
+// Acesso às fases privadas do World (declarado friend em world.h).
+class WorldBench{
+public:
+    static void move(World& w, double dt){ w.moveParticles(0, w.particles.size(), dt); }
+    static void limits(World& w){ w.intersectWithLimits(0, w.particles.size()); }
+};
+
+struct BenchConfig{
+    std::string out = "bench.json";
+    std::string filter;
+    int warmup = 3;
+    int minReps = 15;
+    double minSeconds = 0.3; // tempo mínimo medido por caso
+};
+
+struct BenchResult{
+    std::string name;
+    size_t items;   // operações (particulas, pares, vetores...) por repetição
+    int reps;
+    double medianNs; // por repetição
+    double p99Ns;
+    double nsPerOp;
+    double itemsPerSec;
+};
+
+// Impede que o compilador descarte resultados não usados.
+static volatile double sink;
+
+class BenchRunner{
+
+private:
+    BenchConfig cfg;
+    std::vector<BenchResult> results;
+
+public:
+    explicit BenchRunner(const BenchConfig& cfg): cfg{cfg} {}
+
+    // f executa uma repetição de `items` operações.
+    template<typename F>
+    void run(const std::string& name, size_t items, F&& f){
+        if(!cfg.filter.empty() && name.find(cfg.filter) == std::string::npos){
+            return;
+        }
+        for(int i = 0; i < cfg.warmup; ++i){
+            f();
+        }
+
+        std::vector<double> samples;
+        double total = 0.0;
+        while(static_cast<int>(samples.size()) < cfg.minReps || total < cfg.minSeconds){
+            auto start = std::chrono::steady_clock::now();
+            f();
+            auto end = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration<double, std::nano>(end - start).count();
+            samples.push_back(ns);
+            total += ns * 1e-9;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult r;
+        r.name = name;
+        r.items = items;
+        r.reps = static_cast<int>(samples.size());
+        r.medianNs = samples[samples.size() / 2];
+        r.p99Ns = samples[std::min(samples.size() - 1, (samples.size() * 99) / 100)];
+        r.nsPerOp = r.medianNs / items;
+        r.itemsPerSec = items / (r.medianNs * 1e-9);
+        results.push_back(r);
+
+        std::cout << name << ": mediana " << r.medianNs / 1e3 << " us | p99 " << r.p99Ns / 1e3
+                  << " us | " << r.nsPerOp << " ns/op | " << r.itemsPerSec << " itens/s | "
+                  << r.reps << " rep" << std::endl;
+    }
+
+    bool writeJson() const{
+        std::ofstream file(cfg.out);
+        if(!file){
+            std::cerr << "Não foi possível escrever " << cfg.out << std::endl;
+            return false;
+        }
+        file << "{\n  \"kernel\": \"" << intersectBatchKernelName() << "\",\n  \"results\": [\n";
+        for(size_t i = 0; i < results.size(); ++i){
+            const BenchResult& r = results[i];
+            file << "    {\"name\": \"" << r.name << "\", \"items\": " << r.items
+                 << ", \"reps\": " << r.reps
+                 << ", \"median_ns\": " << r.medianNs << ", \"p99_ns\": " << r.p99Ns
+                 << ", \"ns_per_op\": " << r.nsPerOp << ", \"items_per_s\": " << r.itemsPerSec << "}"
+                 << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n}\n";
+        std::cout << results.size() << " resultados em " << cfg.out << std::endl;
+        return true;
+    }
+};
+
+static bool parseArgs(int argc, char** argv, BenchConfig& cfg){
+    for(int i = 1; i < argc; ++i){
+        if(std::strcmp(argv[i], "--quick") == 0){
+            cfg.warmup = 1;
+            cfg.minReps = 5;
+            cfg.minSeconds = 0.05;
+        }else if(i + 1 < argc && std::strcmp(argv[i], "--out") == 0){
+            cfg.out = argv[++i];
+        }else if(i + 1 < argc && std::strcmp(argv[i], "--filter") == 0){
+            cfg.filter = argv[++i];
+        }else{
+            std::cerr << "Argumento desconhecido: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Mundo de 200x200 com particulas espalhadas (direções de rand(), semente fixa) e
+// segmentos aleatórios de uma semente fixa: os mesmos em todas as execuções.
+static void fillWorld(World& world, long particles, int segments){
+    std::srand(1);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> ux(world.get_xMin(), world.get_xMax());
+    std::uniform_real_distribution<> uy(world.get_yMin(), world.get_yMax());
+    for(long i = 1; i < particles; ++i){
+        world.addParticle(ponto2D{ux(gen), uy(gen)});
+    }
+    for(int i = 0; i < 2 * segments; ++i){
+        world.addSegmentPoint(ponto2D{ux(gen), uy(gen)});
+    }
+}
+
+static void benchVectors(BenchRunner& runner){
+    const size_t n = 4096;
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<> u(-1.0, 1.0);
+    std::vector<vec3> a, b;
+    std::vector<vec2> a2, b2;
+    for(size_t i = 0; i < n; ++i){
+        double x = u(gen), y = u(gen), z = u(gen), w = u(gen);
+        a.emplace_back(x, y, 0.0);
+        b.emplace_back(z, w, 0.0);
+        a2.emplace_back(x, y);
+        b2.emplace_back(z, w);
+    }
+
+    runner.run("vec3/add", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += (a[i] + b[i]).get_x();
+        sink = acc;
+    });
+    runner.run("vec3/dot", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += a[i].dot(b[i]);
+        sink = acc;
+    });
+    runner.run("vec3/cross", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += a[i].cross(b[i]).get_z();
+        sink = acc;
+    });
+    runner.run("vec3/norma", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += a[i].norma();
+        sink = acc;
+    });
+    runner.run("vec3/normalize", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i){
+            vec3 v = a[i];
+            v.normalize();
+            acc += v.get_x();
+        }
+        sink = acc;
+    });
+    runner.run("vec3/reflect", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += reflect(a[i], b[i]).get_x();
+        sink = acc;
+    });
+    runner.run("vec2/dot", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += a2[i].dot(b2[i]);
+        sink = acc;
+    });
+    runner.run("vec2/normalized", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += a2[i].normalized().x;
+        sink = acc;
+    });
+    runner.run("vec2/reflect", n, [&]{
+        double acc = 0.0;
+        for(size_t i = 0; i < n; ++i) acc += reflect(a2[i], b2[i]).x;
+        sink = acc;
+    });
+}
+
+static void benchIntersect(BenchRunner& runner){
+    const size_t n = 4096;
+    std::mt19937 gen(2);
+    std::uniform_real_distribution<> u(-100.0, 100.0);
+    std::vector<ponto2D> p(4 * n);
+    for(ponto2D& q : p){
+        q = ponto2D{u(gen), u(gen)};
+    }
+
+    runner.run("collision/orientation", n, [&]{
+        int acc = 0;
+        for(size_t i = 0; i < n; ++i) acc += orientation(p[4 * i], p[4 * i + 1], p[4 * i + 2]);
+        sink = acc;
+    });
+    runner.run("collision/doIntersect", n, [&]{
+        int acc = 0;
+        for(size_t i = 0; i < n; ++i) acc += doIntersect(p[4 * i], p[4 * i + 1], p[4 * i + 2], p[4 * i + 3]);
+        sink = acc;
+    });
+    std::vector<SegmentEntry> table(n);
+    for(size_t i = 0; i < n; ++i){
+        table[i] = SegmentTable::makeEntry(p[4 * i + 2], p[4 * i + 3]);
+    }
+    runner.run("collision/segmentIntersect", n, [&]{
+        int acc = 0;
+        for(size_t i = 0; i < n; ++i) acc += segmentIntersect(p[4 * i], p[4 * i + 1], table[i]);
+        sink = acc;
+    });
+}
+
+static void benchStepPhases(BenchRunner& runner){
+    const double dt = 1.0 / 60.0;
+    for(long particles : {10000L, 100000L, 1000000L}){
+        World world{-100.0f, 100.0f, -100.0f, 100.0f, 6.0f};
+        fillWorld(world, particles, 0);
+        std::string suffix = "/p" + std::to_string(particles);
+        runner.run("step/moveParticles" + suffix, particles, [&]{ WorldBench::move(world, dt); });
+        runner.run("step/intersectWithLimits" + suffix, particles, [&]{ WorldBench::limits(world); });
+    }
+}
+
+static void benchCollisionPass(BenchRunner& runner){
+    struct Case{ BroadPhase bp; const char* name; int segments; };
+    const Case cases[] = {
+        {BroadPhase::Linear, "linear", 4}, {BroadPhase::Linear, "linear", 64},
+        {BroadPhase::Grid, "grid", 64}, {BroadPhase::Grid, "grid", 1024},
+        {BroadPhase::Bvh, "bvh", 64}, {BroadPhase::Bvh, "bvh", 1024},
+    };
+    const double dt = 1.0 / 60.0;
+
+    for(long particles : {10000L, 100000L}){
+        for(const Case& c : cases){
+            World world{-100.0f, 100.0f, -100.0f, 100.0f, 6.0f};
+            fillWorld(world, particles, c.segments);
+            world.setBroadPhase(c.bp);
+            std::string name = std::string("step/full/") + c.name + "/p" + std::to_string(particles)
+                             + "/s" + std::to_string(c.segments);
+            runner.run(name, particles, [&]{ world.step(dt); });
+        }
+    }
+}
+
+// Lado da CPU do envio para o renderizador: o que main.cpp faz a cada frame
+// (writePositions) e quando os segmentos mudam (writeSegmentVertices).
+static void benchRender(BenchRunner& runner){
+    for(long particles : {100000L, 1000000L}){
+        World world{-100.0f, 100.0f, -100.0f, 100.0f, 6.0f};
+        fillWorld(world, particles, 0);
+        std::vector<float> dst(2 * world.getParticles().size());
+        runner.run("render/writePositions/p" + std::to_string(particles), particles, [&]{
+            world.writePositions(dst.data());
+            sink = dst[0];
+        });
+    }
+    World world{-100.0f, 100.0f, -100.0f, 100.0f, 6.0f};
+    fillWorld(world, 1, 4096);
+    std::vector<float> dst(2 * world.getSegs().size());
+    runner.run("render/writeSegmentVertices/s4096", world.getSegs().size() / 2, [&]{
+        world.writeSegmentVertices(dst.data());
+        sink = dst[0];
+    });
+}
+
+// Leitura de cenas grandes nos dois formatos e a carga no World; os arquivos são
+// criados na pasta atual e apagados no fim.
+static void benchScene(BenchRunner& runner){
+    const size_t segments = 1000000;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> u(-100.0, 100.0);
+    SceneSegments scene;
+    scene.reserve(segments);
+    for(size_t i = 0; i < segments; ++i){
+        scene.add(ponto2D{u(gen), u(gen)}, ponto2D{u(gen), u(gen)});
+    }
+    std::string error;
+    if(!SceneLoader::saveText(scene, "bench_scene.txt", error) || !SceneLoader::saveBinary(scene, "bench_scene.ppsc", error)){
+        std::cerr << "benchScene: " << error << std::endl;
+        return;
+    }
+
+    const std::string suffix = "/s" + std::to_string(segments);
+    SceneSegments loaded;
+    runner.run("scene/loadText" + suffix, segments, [&]{
+        SceneLoader::loadText("bench_scene.txt", loaded, error);
+        sink = loaded.points[0].x;
+    });
+    runner.run("scene/loadBinary" + suffix, segments, [&]{
+        SceneLoader::loadBinary("bench_scene.ppsc", loaded, error);
+        sink = loaded.points[0].x;
+    });
+    runner.run("scene/World::loadSegments" + suffix, segments, [&]{
+        World world{-100.0f, 100.0f, -100.0f, 100.0f, 6.0f};
+        world.loadSegments(loaded);
+        sink = world.getSegs()[0].x;
+    });
+    std::remove("bench_scene.txt");
+    std::remove("bench_scene.ppsc");
+}
+
+int main(int argc, char** argv){
+    BenchConfig cfg;
+    if(!parseArgs(argc, argv, cfg)){
+        return -1;
+    }
+
+    BenchRunner runner{cfg};
+    benchVectors(runner);
+    benchIntersect(runner);
+    benchStepPhases(runner);
+    benchCollisionPass(runner);
+    benchRender(runner);
+    benchScene(runner);
+
+    return runner.writeJson() ? 0 : -1;
+}
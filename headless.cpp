@@ -0,0 +1,488 @@
+#include "Libraries/world.h"
+#include "Libraries/intersect_batch.h"
+#include "Libraries/event_sim.h"
+#include "Libraries/profiler.h"
+#include "Libraries/replay.h"
+#include "Libraries/snapshot.h"
+#include "Libraries/scene.h"
+#include "Libraries/alloc_count.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+// Executável sem janela: avança a simulação o mais rápido possível e mede passos por segundo.
+// Uso: ParticlePhysics.headless [--particles N] [--segments N] [--steps N] [--dt X]
+//                                [--clusters K] [--broadphase linear|grid|bvh]
+//                                [--kernel auto|scalar] [--threads N]
+//                                [--speed S] [--collision discrete|ccd] [--mode step|event]
+//                                [--radius R] [--profile-csv arquivo] (só com PROFILE=1)
+//                                [--events] [--event-log arquivo]
+//                                [--seed N] [--record arquivo] [--hash-every N]
+//                                [--replay arquivo] (só usa --threads)
+//                                [--snapshot-in arquivo] [--snapshot-out arquivo]
+//                                [--scene arquivo] [--scene-export arquivo]
+//                                [--boundary reflect|periodic|absorb|clamp]
+//                                [--capacity N] [--lifetime S] [--emitters N] [--emit-rate R]
+//                                [--absorbing N]
+//                                [--check-allocs] (só com ALLOCS=1)
+
+struct HeadlessConfig{
+    long particles = 1000;
+    int segments = 4;
+    long steps = 1000;
+    double dt = 1.0 / 60.0;
+    BroadPhase broadPhase = BroadPhase::Linear;
+    int clusters = 0; // > 0: segmentos curtos agrupados em vez de randomSegs
+    unsigned threads = 1; // 0 --> todos os núcleos
+    float speed = 6.0f;
+    CollisionMode collisionMode = CollisionMode::Discrete;
+    Boundary boundary = Boundary::Reflect;
+    bool eventDriven = false; // --mode event: EventSimulation em vez de World::step
+    double radius = 0.0; // > 0: colisão entre particulas; elas nascem espalhadas pelo plano
+    const char* profileCsv = nullptr; // Uma linha por passo (cada passo é um "frame" do profiler)
+    bool events = false;              // Publica as colisões para uma thread que as conta
+    bool checkAllocs = false;         // Falha se algum passo depois do aquecimento alocar
+    const char* eventLog = nullptr;   // ...e as grava neste log binário
+    bool hasSeed = false;
+    uint64_t seed = 0;
+    const char* record = nullptr;     // Grava a execução (ver replay.h)
+    unsigned hashEvery = 60;          // Passos entre hashes de estado gravados
+    const char* replay = nullptr;     // Reproduz uma gravação em vez de montar a cena
+    const char* snapshotIn = nullptr;  // Continua de um snapshot em vez de montar a cena
+    const char* snapshotOut = nullptr; // Grava um snapshot depois dos passos
+    const char* scene = nullptr;       // Segmentos de uma cena em vez de randomSegs/clusters
+    const char* sceneExport = nullptr; // Grava os segmentos do World como cena binária
+    size_t capacity = 0;      // > 0: pool de particulas com capacidade fixa
+    double lifetime = 0.0;    // > 0: tempo de vida das particulas criadas (segundos simulados)
+    int emitters = 0;         // Emissores em pontos aleatórios do plano...
+    double emitRate = 1000.0; // ...cada um criando emitRate particulas por segundo simulado
+    int absorbing = 0;        // Os primeiros N segmentos absorvem as particulas
+};
+
+// Cena não uniforme: segmentos curtos concentrados em torno de alguns centros,
+// com grandes regiões vazias entre eles.
+static void clusteredSegs(World& world, int count, int clusters){
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<> center_x(world.get_xMin(), world.get_xMax());
+    std::uniform_real_distribution<> center_y(world.get_yMin(), world.get_yMax());
+    std::normal_distribution<> spread(0.0, 5.0);
+    std::uniform_real_distribution<> offset(-1.0, 1.0);
+
+    std::vector<ponto2D> centers;
+    for(int c = 0; c < clusters; ++c){
+        centers.emplace_back(center_x(gen), center_y(gen));
+    }
+    for(int i = 0; i < count; ++i){
+        const ponto2D& c = centers[i % clusters];
+        double x = c.x + spread(gen);
+        double y = c.y + spread(gen);
+        world.addSegmentPoint(ponto2D{x, y});
+        world.addSegmentPoint(ponto2D{x + offset(gen), y + offset(gen)});
+    }
+}
+
+// Particulas, segmentos e configuração da linha de comando.
+static bool buildScene(World& world, const HeadlessConfig& cfg){
+    // O pool é reservado antes de qualquer particula.
+    world.setParticleCapacity(cfg.capacity);
+    world.setParticleLifetime(cfg.lifetime);
+    // A particula principal já existe após o reset do World. Com raio, todas nascendo
+    // na origem ficariam no mesmo balde do hash; espalha-as pelo plano.
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<> spawn_x(world.get_xMin(), world.get_xMax());
+    std::uniform_real_distribution<> spawn_y(world.get_yMin(), world.get_yMax());
+    for(long i = 1; i < cfg.particles; ++i){
+        if(cfg.radius > 0.0){
+            world.addParticle(ponto2D{spawn_x(gen), spawn_y(gen)});
+        }else{
+            world.addParticle(ponto2D{0.0, 0.0});
+        }
+    }
+    if(cfg.scene){
+        auto loadStart = std::chrono::steady_clock::now();
+        SceneSegments scene;
+        std::string error;
+        if(!SceneLoader::load(cfg.scene, scene, error)){
+            std::cerr << "Cena inválida: " << error << std::endl;
+            return false;
+        }
+        world.loadSegments(scene);
+        double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << "Cena: " << scene.size() << " segmentos carregados em " << loadSeconds * 1e3 << " ms" << std::endl;
+    }else if(cfg.clusters > 0){
+        clusteredSegs(world, cfg.segments, cfg.clusters);
+    }else{
+        world.randomSegs(cfg.segments);
+    }
+    for(int s = 0; s < cfg.absorbing; ++s){
+        world.setSegmentAbsorbing(static_cast<uint32_t>(s), true);
+    }
+    for(int e = 0; e < cfg.emitters; ++e){
+        Emitter emitter;
+        emitter.position = ponto2D{spawn_x(gen), spawn_y(gen)};
+        emitter.rate = cfg.emitRate;
+        emitter.lifetime = cfg.lifetime > 0.0 ? cfg.lifetime : ParticleArrays::IMMORTAL;
+        world.addEmitter(emitter);
+    }
+    world.setBroadPhase(cfg.broadPhase);
+    world.setCollisionMode(cfg.collisionMode);
+    world.setBoundary(cfg.boundary);
+    world.setParticleRadius(cfg.radius);
+    return true;
+}
+
+static bool parseArgs(int argc, char** argv, HeadlessConfig& cfg){
+    for(int i = 1; i < argc; ++i){
+        // --events e --check-allocs são os únicos argumentos sem valor.
+        if(std::strcmp(argv[i], "--events") == 0){
+            cfg.events = true;
+            continue;
+        }
+        if(std::strcmp(argv[i], "--check-allocs") == 0){
+            cfg.checkAllocs = true;
+            continue;
+        }
+        if(i + 1 >= argc){
+            std::cerr << "Argumento sem valor: " << argv[i] << std::endl;
+            return false;
+        }
+        if(std::strcmp(argv[i], "--particles") == 0){
+            cfg.particles = std::atol(argv[++i]);
+        }else if(std::strcmp(argv[i], "--segments") == 0){
+            cfg.segments = std::atoi(argv[++i]);
+        }else if(std::strcmp(argv[i], "--steps") == 0){
+            cfg.steps = std::atol(argv[++i]);
+        }else if(std::strcmp(argv[i], "--dt") == 0){
+            cfg.dt = std::atof(argv[++i]);
+        }else if(std::strcmp(argv[i], "--clusters") == 0){
+            cfg.clusters = std::atoi(argv[++i]);
+        }else if(std::strcmp(argv[i], "--speed") == 0){
+            cfg.speed = static_cast<float>(std::atof(argv[++i]));
+        }else if(std::strcmp(argv[i], "--collision") == 0){
+            std::string mode = argv[++i];
+            if(mode == "discrete"){
+                cfg.collisionMode = CollisionMode::Discrete;
+            }else if(mode == "ccd"){
+                cfg.collisionMode = CollisionMode::Continuous;
+            }else{
+                std::cerr << "Modo de colisão desconhecido: " << mode << std::endl;
+                return false;
+            }
+        }else if(std::strcmp(argv[i], "--mode") == 0){
+            std::string mode = argv[++i];
+            if(mode == "event"){
+                cfg.eventDriven = true;
+            }else if(mode != "step"){
+                std::cerr << "Modo desconhecido: " << mode << std::endl;
+                return false;
+            }
+        }else if(std::strcmp(argv[i], "--seed") == 0){
+            cfg.hasSeed = true;
+            cfg.seed = std::strtoull(argv[++i], nullptr, 10);
+        }else if(std::strcmp(argv[i], "--record") == 0){
+            cfg.record = argv[++i];
+        }else if(std::strcmp(argv[i], "--hash-every") == 0){
+            cfg.hashEvery = static_cast<unsigned>(std::atoi(argv[++i]));
+        }else if(std::strcmp(argv[i], "--boundary") == 0){
+            if(!parseBoundary(argv[++i], cfg.boundary)){
+                std::cerr << "Limite desconhecido: " << argv[i] << std::endl;
+                return false;
+            }
+        }else if(std::strcmp(argv[i], "--scene") == 0){
+            cfg.scene = argv[++i];
+        }else if(std::strcmp(argv[i], "--scene-export") == 0){
+            cfg.sceneExport = argv[++i];
+        }else if(std::strcmp(argv[i], "--snapshot-in") == 0){
+            cfg.snapshotIn = argv[++i];
+        }else if(std::strcmp(argv[i], "--snapshot-out") == 0){
+            cfg.snapshotOut = argv[++i];
+        }else if(std::strcmp(argv[i], "--replay") == 0){
+            cfg.replay = argv[++i];
+        }else if(std::strcmp(argv[i], "--event-log") == 0){
+            cfg.events = true;
+            cfg.eventLog = argv[++i];
+        }else if(std::strcmp(argv[i], "--profile-csv") == 0){
+            cfg.profileCsv = argv[++i];
+        }else if(std::strcmp(argv[i], "--radius") == 0){
+            cfg.radius = std::atof(argv[++i]);
+        }else if(std::strcmp(argv[i], "--capacity") == 0){
+            cfg.capacity = static_cast<size_t>(std::atol(argv[++i]));
+        }else if(std::strcmp(argv[i], "--lifetime") == 0){
+            cfg.lifetime = std::atof(argv[++i]);
+        }else if(std::strcmp(argv[i], "--emitters") == 0){
+            cfg.emitters = std::atoi(argv[++i]);
+        }else if(std::strcmp(argv[i], "--emit-rate") == 0){
+            cfg.emitRate = std::atof(argv[++i]);
+        }else if(std::strcmp(argv[i], "--absorbing") == 0){
+            cfg.absorbing = std::atoi(argv[++i]);
+        }else if(std::strcmp(argv[i], "--threads") == 0){
+            cfg.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        }else if(std::strcmp(argv[i], "--kernel") == 0){
+            std::string k = argv[++i];
+            if(k == "scalar"){
+                forceScalarIntersectBatch(true);
+            }else if(k != "auto"){
+                std::cerr << "Kernel desconhecido: " << k << std::endl;
+                return false;
+            }
+        }else if(std::strcmp(argv[i], "--broadphase") == 0){
+            std::string bp = argv[++i];
+            if(bp == "linear"){
+                cfg.broadPhase = BroadPhase::Linear;
+            }else if(bp == "grid"){
+                cfg.broadPhase = BroadPhase::Grid;
+            }else if(bp == "bvh"){
+                cfg.broadPhase = BroadPhase::Bvh;
+            }else{
+                std::cerr << "Broad-phase desconhecida: " << bp << std::endl;
+                return false;
+            }
+        }else{
+            std::cerr << "Argumento desconhecido: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reexecuta uma gravação e confere os hashes de estado gravados nela.
+static int runReplay(const HeadlessConfig& cfg){
+    SimulationReplay replay;
+    std::string error;
+    if(!replay.load(cfg.replay, error)){
+        std::cerr << "Gravação inválida: " << error << std::endl;
+        return -1;
+    }
+    replay.getWorld().setThreadCount(cfg.threads);
+
+    auto start = std::chrono::steady_clock::now();
+    ReplayResult result = replay.run();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Reprodução: " << result.steps << " passos de " << replay.get_dt() << " s | semente "
+              << replay.get_seed() << " | " << replay.getWorld().getParticles().size() << " particulas" << std::endl;
+    std::cout << "Tempo: " << seconds << " s | " << result.steps / seconds << " passos/s" << std::endl;
+    if(!result.ok){
+        std::cout << "Hash divergente no passo " << result.firstMismatch << " (" << result.hashesChecked
+                  << " hashes conferidos)" << std::endl;
+        return 1;
+    }
+    std::cout << "OK: " << result.hashesChecked << " hashes conferidos" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv){
+    HeadlessConfig cfg;
+    if(!parseArgs(argc, argv, cfg)){
+        return -1;
+    }
+
+    if(cfg.replay){
+        return runReplay(cfg);
+    }
+
+    std::unique_ptr<World> worldPtr;
+    if(cfg.snapshotIn){
+        auto loadStart = std::chrono::steady_clock::now();
+        std::string error;
+        worldPtr = WorldSnapshot::load(cfg.snapshotIn, error);
+        if(!worldPtr){
+            std::cerr << "Snapshot inválido: " << error << std::endl;
+            return -1;
+        }
+        double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << "Snapshot restaurado em " << loadSeconds * 1e3 << " ms (passo " << worldPtr->get_stepCount()
+                  << ", t = " << worldPtr->get_time() << " s)" << std::endl;
+    }else{
+        worldPtr.reset(new World{-100.0f, 100.0f, -100.0f, 100.0f, cfg.speed});
+    }
+    World& world = *worldPtr;
+    if(cfg.hasSeed){
+        world.setSeed(cfg.seed);
+    }
+    // Grava desde antes da montagem da cena, então ela entra como comandos.
+    SimulationRecorder recorder;
+    if(cfg.record && !recorder.begin(cfg.record, world, cfg.hasSeed ? cfg.seed : std::random_device{}(), cfg.dt, cfg.hashEvery)){
+        std::cerr << "Não foi possível criar " << cfg.record << std::endl;
+        return -1;
+    }
+
+    if(!cfg.snapshotIn && !buildScene(world, cfg)){
+        return -1;
+    }
+    if(cfg.sceneExport){
+        std::string error;
+        if(!SceneLoader::saveBinary(SceneLoader::fromPoints(world.getSegs()), cfg.sceneExport, error)){
+            std::cerr << "Cena não gravada: " << error << std::endl;
+            return -1;
+        }
+    }
+    world.setThreadCount(cfg.threads);
+
+    if(cfg.eventDriven){
+        // As paredes do EventSimulation só refletem.
+        if(world.getBoundary() != Boundary::Reflect){
+            std::cerr << "--mode event só simula --boundary reflect" << std::endl;
+            return -1;
+        }
+        // Mesmo tempo simulado que cfg.steps passos de cfg.dt.
+        auto start = std::chrono::steady_clock::now();
+        EventSimulation sim{world};
+        for(long i = 1; i <= cfg.steps; ++i){
+            sim.advanceTo(i * cfg.dt);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        std::cout << "Particulas: " << sim.size() << " | Segmentos: " << world.getSegs().size() / 2
+                  << " | Modo: eventos" << std::endl;
+        std::cout << "Tempo: " << seconds << " s | Tempo simulado: " << sim.get_time() << " s | "
+                  << sim.get_time() / seconds << " s simulados/s | " << sim.get_events() << " eventos" << std::endl;
+        return 0;
+    }
+
+#ifdef PARTICLE_PROFILE
+    if(cfg.profileCsv && !FrameProfiler::instance().openCsv(cfg.profileCsv)){
+        std::cerr << "Não foi possível abrir " << cfg.profileCsv << std::endl;
+        return -1;
+    }
+#else
+    if(cfg.profileCsv){
+        std::cerr << "--profile-csv ignorado: compile com make headless PROFILE=1" << std::endl;
+    }
+#endif
+
+    CollisionLog collisionLog;
+    if(cfg.events){
+        if(cfg.eventLog && !collisionLog.openFile(cfg.eventLog)){
+            std::cerr << "Não foi possível abrir " << cfg.eventLog << std::endl;
+            return -1;
+        }
+        world.setCollisionLog(&collisionLog);
+        collisionLog.reserveSegments(world.getSegmentTable().size());
+        collisionLog.start();
+    }
+
+    if(cfg.checkAllocs && !allocationCountingEnabled()){
+        std::cerr << "--check-allocs precisa de make headless ALLOCS=1" << std::endl;
+        return -1;
+    }
+    // Os primeiros passos dimensionam os buffers (hash, pares, candidatos); depois
+    // deles o passo não deveria alocar mais nada. Com --check-allocs cada passo também faz
+    // o lado da CPU do envio de um frame (writePositions), como main.cpp no buffer mapeado.
+    std::vector<float> framePositions;
+    if(cfg.checkAllocs){
+        framePositions.reserve(2 * std::max(world.getParticleCapacity(), world.getParticles().size()));
+    }
+    const long warmup = std::min(cfg.steps, std::max(10L, cfg.steps / 10));
+    uint64_t steadyAllocs = 0;
+    uint64_t steadyBytes = 0;
+    uint64_t worstStepAllocs = 0;
+    long firstAllocStep = -1;
+
+    auto start = std::chrono::steady_clock::now();
+    for(long i = 0; i < cfg.steps; ++i){
+        AllocStats before = allocationStats();
+        {
+            PROFILE_SCOPE(ProfilePhase::Simulation);
+            world.step(cfg.dt);
+        }
+        PROFILE_END_FRAME();
+        if(cfg.checkAllocs){
+            framePositions.resize(2 * world.getParticles().size());
+            world.writePositions(framePositions.data());
+        }
+        if(cfg.checkAllocs && i >= warmup){
+            AllocStats after = allocationStats();
+            uint64_t stepAllocs = after.count - before.count;
+            steadyAllocs += stepAllocs;
+            steadyBytes += after.bytes - before.bytes;
+            worstStepAllocs = std::max(worstStepAllocs, stepAllocs);
+            if(stepAllocs > 0 && firstAllocStep < 0){
+                firstAllocStep = i;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    collisionLog.stop();
+    recorder.finish(world);
+
+    if(cfg.snapshotOut){
+        auto saveStart = std::chrono::steady_clock::now();
+        std::string error;
+        if(!WorldSnapshot::save(world, cfg.snapshotOut, error)){
+            std::cerr << "Snapshot não gravado: " << error << std::endl;
+            return -1;
+        }
+        double saveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - saveStart).count();
+        std::cout << "Snapshot gravado em " << saveSeconds * 1e3 << " ms: " << cfg.snapshotOut << std::endl;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << "Particulas: " << world.getParticles().size()
+              << " | Segmentos: " << world.getSegs().size() / 2
+              << " | Passos: " << cfg.steps
+              << " | Kernel: " << intersectBatchKernelName()
+              << " | Threads: " << world.getThreadCount()
+              << " | Raio: " << world.getParticleRadius() << std::endl;
+    std::cout << "Tempo: " << seconds << " s | "
+              << cfg.steps / seconds << " passos/s | "
+              << cfg.steps * cfg.dt / seconds << " s simulados/s | "
+              << (cfg.steps * static_cast<double>(world.getParticles().size())) / seconds << " particulas*passo/s" << std::endl;
+    std::cout << "Memoria por passada: " << world.getParticles().size() * world.getParticles().bytesPerParticle()
+              << " bytes (" << world.getParticles().bytesPerParticle() << " bytes/particula)" << std::endl;
+
+    const ParticlePoolStats& pool = world.getPoolStats();
+    if(pool.despawned > 0 || pool.dropped > 0 || !world.getEmitters().empty()){
+        std::cout << "Pool: " << pool.spawned << " criadas | " << pool.despawned << " removidas | "
+                  << pool.dropped << " descartadas | capacidade " << world.getParticleCapacity()
+                  << " | " << pool.despawned / seconds << " remocoes/s" << std::endl;
+    }
+
+    if(cfg.events){
+        std::cout << "Colisoes: " << collisionLog.get_consumed() << " consumidas | "
+                  << collisionLog.get_dropped() << " descartadas (fila cheia)" << std::endl;
+    }
+
+    if(cfg.checkAllocs){
+        std::cout << "Alocacoes: " << steadyAllocs << " (" << steadyBytes << " bytes) em "
+                  << cfg.steps - warmup << " passos depois de " << warmup << " de aquecimento | pior passo: "
+                  << worstStepAllocs << std::endl;
+        if(steadyAllocs > 0){
+            std::cout << "FALHA: o passo " << firstAllocStep << " alocou" << std::endl;
+            return 1;
+        }
+        std::cout << "OK: nenhuma alocacao por passo" << std::endl;
+    }
+
+    if(world.getBroadPhase() == BroadPhase::Grid){
+        const SegmentGrid& grid = world.getGrid();
+        std::cout << "Grade: " << grid.get_cols() << "x" << grid.get_rows()
+                  << " | " << grid.memoryBytes() << " bytes" << std::endl;
+    }else if(world.getBroadPhase() == BroadPhase::Bvh){
+        const SegmentBVH& bvh = world.getBvh();
+        std::cout << "BVH: " << bvh.nodeCount() << " nos | " << bvh.memoryBytes() << " bytes" << std::endl;
+    }
+
+#ifdef PARTICLE_PROFILE
+    // Últimos FrameProfiler::WINDOW passos; as fases de dentro do passo somam todas as threads.
+    std::cout << "Fases (ms por passo, min/media/p99):" << std::endl;
+    for(int p = 0; p < static_cast<int>(ProfilePhase::COUNT); ++p){
+        ProfilePhase phase = static_cast<ProfilePhase>(p);
+        if(phase == ProfilePhase::Render || phase == ProfilePhase::Swap){
+            continue;
+        }
+        PhaseStats st = FrameProfiler::instance().stats(phase);
+        std::cout << "  " << FrameProfiler::phaseName(phase) << ": " << st.minMs << " / " << st.avgMs
+                  << " / " << st.p99Ms << std::endl;
+    }
+#endif
+
+    return 0;
+}
@@ -1,15 +1,19 @@
-#include "Libraries/vectors.h"
-#include "Libraries/point.h"
+#include "Libraries/world.h"
+#include "Libraries/renderer.h"
+#include "Libraries/clock.h"
+#include "Libraries/replay.h"
+#include "Libraries/scene.h"
+#include "Libraries/alloc_count.h"
 #include "glad/include/glad/glad.h"
 #include <GLFW/glfw3.h>
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtc/type_ptr.hpp"
-#include <vector>
 #include <array>
-#include <random>
-#include <utility>
+#include <cstdio>
 #include <cstdlib>
-#include <ctime>
+#include <cstring>
+#include <iostream>
+#include <string>
 
 // Janela 800x800
 const unsigned int WIDTH = 800;
@@ -22,199 +26,52 @@ float yMin = -100.0f;
 float yMax = 100.0f;
 
 //Variáveis Globais
-std::vector<ponto2D> segs;
-ponto2D mainPoint; // Sempre nasce na origem e vai ter sentido 45 Graus no 1º Quadrante.
-vec3 mainDirection{(std::cos(M_PI/4)), (std::sin(M_PI/4)), 0.0};
-std::vector<std::pair<ponto2D, vec3>> particles = {std::make_pair(mainPoint, mainDirection)};
-float speed = 0.1f;
-
-
-// Gera 4 segmentos de retas aleatórios
-void randomSegs(){
-    
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> distrib_x(xMin, xMax);
-    std::uniform_real_distribution<> distrib_y(yMin, yMax);
-    
-    for(int i = 0; i < 8; ++i){
-        double x = distrib_x(gen);
-        double y = distrib_y(gen);
-        segs.emplace_back(ponto2D(x, y));    
-    }
-
-}
-
-// Gera um sentido aleatório que a particula seguirá ao nascer
-vec3 randomDirection(){
-
-    // Angulo entre 0 e 2PI
-    double angle = static_cast<double>(rand()) / RAND_MAX  * 2.0f * M_PI;
-
-    return vec3{std::cos(angle), std::sin(angle), 0.0};
-}
-
-// Lida com o caso especial que o ponto Q é colinear ao segmento PR e verifica se
-// Q está dentro dos limites do segmento da reta
-bool onSegment(const ponto2D& p, const ponto2D& q, const ponto2D& r) {
-    return q.x <= std::max(p.x, r.x) && q.x >= std::min(p.x, r.x) &&
-           q.y <= std::max(p.y, r.y) && q.y >= std::min(p.y, r.y);
-}
+float speed = 6.0f; // Unidades por segundo (0.1 por frame a 60 Hz)
+World world{xMin, xMax, yMin, yMax, speed};
 
-// Usa Cross Product para verificar a orientação entre o ponto e o Segmento
-// 0 --> Colinear
-// 1 --> Sentido Horário
-// 2 --> Sentido Anti-Horário
-
-// Mesma ideia usada em Triangulação de pontos.
-int orientation(const ponto2D& p, const ponto2D& q, const ponto2D& r) {
-    double val = (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
-    if (val == 0) return 0;
-    return (val > 0) ? 1 : 2;
-}
-
-// A ideia vai ser lidar com: a particula no frame atual, a particula do frame seguinte (projetada dado a dir),
-// o ponto a e o ponto b (Segmento de reta que pode gerar a colisão).
-bool doIntersect(const ponto2D& p1, const ponto2D& q1, const ponto2D& p2, const ponto2D& q2) {
-    int o1 = orientation(p1, q1, p2);
-    int o2 = orientation(p1, q1, q2);
-    int o3 = orientation(p2, q2, p1);
-    int o4 = orientation(p2, q2, q1);
-
-    if (o1 != o2 && o3 != o4) {return true;} // Caso Base: Retas que se cruzam com sentidos e angulos distintos.
-
-    //Exemplo:
-    /*
-
-                                a
-                                |
-                                |
-                                |    
-        ponto_neste_frame ------------- ponto_no_proximo_frame
-                                |
-                                |
-                                |
-                                b
-    */
-
-
-    // Caso Especial de Colinearidade
-    if (o1 == 0 && onSegment(p1, p2, q1)) {return true;}
-    if (o2 == 0 && onSegment(p1, q2, q1)) {return true;}
-    if (o3 == 0 && onSegment(p2, p1, q2)) {return true;}
-    if (o4 == 0 && onSegment(p2, q1, q2)) {return true;}
-
-    return false;
-}
-
-//Calcula a Normal de um Segmento de Reta
-vec3 calculateNormal(const ponto2D& a, const ponto2D& b){
-    vec3 normal{b.y - a.y, a.x - b.x, 0.0};
-    normal.normalize();
-    return normal;
-}
-
-// Reflete uma direção usando a normal do segmento
-vec3 reflect(const vec3& dir, const vec3& normal) {
-    double dotProduct = dir.dot(normal);
-    vec3 reflection{dir.get_x() - 2 * dotProduct * normal.get_x(), dir.get_y() - 2 * dotProduct * normal.get_y(), 0.0};
-    return reflection;
-}
 
-bool pointIntersectsSegment(const ponto2D& point, const vec3& dir, const ponto2D& a, const ponto2D& b) {
-    ponto2D projectedPoint;
-    projectedPoint.x = point.x + dir.get_x() * speed;
-    projectedPoint.y = point.y + dir.get_y() * speed;
-    return doIntersect(point, projectedPoint, a, b);
-}
-
-
-// É chamada a cada frame para verificar inteseção da particula com algum segmento
-void checkIntersect(const ponto2D& a, const ponto2D& b){
-    for (auto& particle : particles) {
-        ponto2D& point = particle.first;
-        vec3& dir = particle.second;
-        
-        if (pointIntersectsSegment(point, dir, a, b)) {
-            std::cout << "Colisão detectada!!!" << std::endl;
-
-            vec3 normal = calculateNormal(a, b);
-            vec3 newDirection = reflect(dir, normal);
-
-            dir = newDirection;
-        }
-    }
-}
-
-// Normal dos Limites da janela (Trivial)
-vec3 getBorderNormal(const ponto2D& pos) {
-    if (pos.x <= xMin) return vec3{1.0f, 0.0f, 0.0f};
-    if (pos.x >= xMax) return vec3{-1.0f, 0.0f, 0.0f};
-    if (pos.y <= yMin) return vec3{0.0f, 1.0f, 0.0f};
-    if (pos.y >= yMax) return vec3{0.0f, -1.0f, 0.0f};
-    return vec3{0.0f, 0.0f, 0.0f};
-}
-
-// Check a colisão com os limites da janela gráfica
-void intersectWithLimits() {
-    for (auto& particle : particles) {
-        ponto2D& pos = particle.first;
-        vec3& dir = particle.second;
-
-        vec3 normal = getBorderNormal(pos);
-        if (normal.get_x() != 0.0f || normal.get_y() != 0.0f) {
-            vec3 newDirection = reflect(dir, normal);
-            dir = newDirection;
-        }
-    }
+// Mouse --> Coordenadas de Mundo.
+ponto2D cursorPosition(GLFWwindow* window) {
+    double xpos, ypos;
+    glfwGetCursorPos(window, &xpos, &ypos);
+    double x = static_cast<double>((xpos / WIDTH) * (xMax - xMin) + xMin);
+    double y = static_cast<double>(((HEIGHT - ypos) / HEIGHT) * (yMax - yMin) + yMin);
+    return ponto2D{x, y};
 }
 
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
-        double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
-        // Mouse --> Coordenadas de Mundo.
-        double x = static_cast<double>((xpos / WIDTH) * (xMax - xMin) + xMin);
-        double y = static_cast<double>(((HEIGHT - ypos) / HEIGHT) * (yMax - yMin) + yMin);
-        segs.emplace_back(ponto2D{x, y});
+        world.addSegmentPoint(cursorPosition(window));
     }
     if(button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS){
-        double xpos, ypos;
-        glfwGetCursorPos(window, &xpos, &ypos);
-        // Mouse --> Coordenadas de Mundo.
-        double x = static_cast<double>((xpos / WIDTH) * (xMax - xMin) + xMin);
-        double y = static_cast<double>(((HEIGHT - ypos) / HEIGHT) * (yMax - yMin) + yMin);
-        particles.emplace_back(ponto2D{x, y}, randomDirection());
+        world.addParticle(cursorPosition(window));
     }
 }
 
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
     if (key == GLFW_KEY_R && action == GLFW_PRESS) {
-        if (segs.size() == 8) {return;}
-        randomSegs();
+        world.randomSegs();
     }
     if (key == GLFW_KEY_E && action == GLFW_PRESS) {
-        segs.clear();
-        particles.clear();
-        mainPoint.x = 0.0; mainPoint.y = 0.0;
-        particles.emplace_back(mainPoint, vec3{(std::cos(M_PI/4)), (std::sin(M_PI/4)), 0.0});
+        world.reset();
     }
     if(key == GLFW_KEY_N && action == GLFW_PRESS){
-        particles.emplace_back(ponto2D{0.0, 0.0}, randomDirection());
+        world.addParticle(ponto2D{0.0, 0.0});
     }
-}
-
-// Faz todas as particulas do vector de particulas andarem seguindo a direção daquela particula.
-void moveParticles(){
-    for(int i = 0; i < particles.size(); ++i){
-        ponto2D pos = particles[i].first;
-        vec3 dir = particles[i].second;
-
-        dir.normalize();
-
-        vec3 v = dir * speed;
-        
-        particles[i].first = ponto2D{(pos.x + v.get_x()), (pos.y + v.get_y())};
+    if(key == GLFW_KEY_M && action == GLFW_PRESS){
+        // Emissor no cursor; sem --lifetime as particulas dele vivem 5 s.
+        Emitter emitter;
+        emitter.position = cursorPosition(window);
+        emitter.rate = 500.0;
+        emitter.lifetime = world.getParticleLifetime() != ParticleArrays::IMMORTAL ? world.getParticleLifetime() : 5.0;
+        world.addEmitter(emitter);
+    }
+    if(key == GLFW_KEY_A && action == GLFW_PRESS){
+        const SegmentTable& table = world.getSegmentTable();
+        if(!table.empty()){
+            uint32_t last = static_cast<uint32_t>(table.size() - 1);
+            world.setSegmentAbsorbing(last, !table.absorbs(last));
+        }
     }
 }
 
@@ -234,6 +91,28 @@ unsigned int compileShader(unsigned int type, const char* source) {
     return shader;
 }
 
+unsigned int createProgram(const char* vertexShaderSource, const char* fragmentShaderSource) {
+    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
+    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+
+    unsigned int shaderProgram = glCreateProgram();
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+    glLinkProgram(shaderProgram);
+
+    int success;
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
+        std::cerr << "Erro ao vincular shaders: " << infoLog << std::endl;
+    }
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return shaderProgram;
+}
+
 unsigned int setupCartesianPlane(float xMin, float xMax, float yMin, float yMax) {
     std::array<float, 12> planeVertices = {
         xMin, 0.0f, 0.0f,   xMax, 0.0f, 0.0f,  // Eixo X
@@ -257,67 +136,95 @@ unsigned int setupCartesianPlane(float xMin, float xMax, float yMin, float yMax)
     return vao;
 }
 
-void drawPoint(const ponto2D& p, unsigned int shaderProgram, glm::mat4 projection, float red, float green, float blue){
-    float pointVertices[] = {
-        p.x, p.y, 0.0f
-    };
-    
-    unsigned int vao, vbo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(pointVertices), pointVertices, GL_STATIC_DRAW);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glUseProgram(shaderProgram);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glUniform3f(glGetUniformLocation(shaderProgram, "color"), red, green, blue);
-    
-    glPointSize(7.0f);
-    glDrawArrays(GL_POINTS, 0, 1);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-}
+// Uso: ParticlePhysics.diego [--particles N] [--hz F] [--substeps N] [--max-catch-up N]
+//                            [--speed S] [--collision discrete|ccd] [--radius R]
+//                            [--profile-csv arquivo] (só com PROFILE=1) [--event-log arquivo]
+//                            [--record arquivo] (reproduzir com ParticlePhysics.headless --replay)
+//                            [--scene arquivo] (segmentos em texto ou binário, ver scene.h)
+//                            [--boundary reflect|periodic|absorb|clamp]
+//                            [--capacity N] [--lifetime S]
+// Com make all ALLOCS=1 o título mostra as alocações do heap por frame.
+int main(int argc, char** argv){
+    double simHz = 60.0;    // Passos fixos por segundo simulado
+    int substeps = 1;       // Chamadas de World::step por passo fixo
+    int maxCatchUp = 8;     // Passos fixos por frame, no máximo
+    long particleCount = 1;
+    const char* profileCsv = nullptr;
+    const char* eventLog = nullptr;
+    const char* record = nullptr;
+    const char* scenePath = nullptr;
+
+    for(int i = 1; i + 1 < argc; i += 2){
+        if(std::strcmp(argv[i], "--particles") == 0){
+            particleCount = std::atol(argv[i + 1]);
+        }else if(std::strcmp(argv[i], "--event-log") == 0){
+            eventLog = argv[i + 1];
+        }else if(std::strcmp(argv[i], "--boundary") == 0){
+            Boundary boundary;
+            if(!parseBoundary(argv[i + 1], boundary)){
+                std::cerr << "Limite desconhecido: " << argv[i + 1] << std::endl;
+                return -1;
+            }
+            world.setBoundary(boundary);
+        }else if(std::strcmp(argv[i], "--scene") == 0){
+            scenePath = argv[i + 1];
+        }else if(std::strcmp(argv[i], "--record") == 0){
+            record = argv[i + 1];
+        }else if(std::strcmp(argv[i], "--profile-csv") == 0){
+            profileCsv = argv[i + 1];
+        }else if(std::strcmp(argv[i], "--radius") == 0){
+            world.setParticleRadius(std::atof(argv[i + 1]));
+        }else if(std::strcmp(argv[i], "--capacity") == 0){
+            world.setParticleCapacity(static_cast<size_t>(std::atol(argv[i + 1])));
+        }else if(std::strcmp(argv[i], "--lifetime") == 0){
+            world.setParticleLifetime(std::atof(argv[i + 1]));
+        }else if(std::strcmp(argv[i], "--hz") == 0){
+            simHz = std::atof(argv[i + 1]);
+        }else if(std::strcmp(argv[i], "--substeps") == 0){
+            substeps = std::atoi(argv[i + 1]);
+        }else if(std::strcmp(argv[i], "--max-catch-up") == 0){
+            maxCatchUp = std::atoi(argv[i + 1]);
+        }else if(std::strcmp(argv[i], "--speed") == 0){
+            world.setSpeed(static_cast<float>(std::atof(argv[i + 1])));
+        }else if(std::strcmp(argv[i], "--collision") == 0){
+            std::string mode = argv[i + 1];
+            world.setCollisionMode(mode == "ccd" ? CollisionMode::Continuous : CollisionMode::Discrete);
+        }else{
+            std::cerr << "Argumento desconhecido: " << argv[i] << std::endl;
+            return -1;
+        }
+    }
 
-void drawSegment(const ponto2D& p1, const ponto2D& p2, unsigned int shaderProgram, glm::mat4 projection, float red, float green, float blue) {
-    float lineVertices[] = {
-        p1.x, p1.y, 0.0f,
-        p2.x, p2.y, 0.0f
-    };
-    
-    unsigned int vao, vbo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(lineVertices), lineVertices, GL_STATIC_DRAW);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    glUseProgram(shaderProgram);
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
-    glUniform3f(glGetUniformLocation(shaderProgram, "color"), red, green, blue);
-    
-    glDrawArrays(GL_LINES, 0, 2);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-}
+    // Grava antes de criar as particulas: elas, os cliques e as teclas viram comandos
+    // registrados pelo próprio World.
+    SimulationRecorder recorder;
+    if(record && !recorder.begin(record, world, std::random_device{}(), 1.0 / simHz / substeps)){
+        std::cerr << "Não foi possível criar " << record << std::endl;
+        return -1;
+    }
+
+    if(scenePath){
+        SceneSegments scene;
+        std::string error;
+        if(!SceneLoader::load(scenePath, scene, error)){
+            std::cerr << "Cena inválida: " << error << std::endl;
+            return -1;
+        }
+        world.loadSegments(scene);
+    }
+
+    // A particula principal já existe após o reset do World. Com raio, nascer todas na
+    // origem as deixaria sobrepostas; nesse caso nascem em pontos aleatórios do plano.
+    for(long p = 1; p < particleCount; ++p){
+        if(world.getParticleRadius() > 0.0){
+            double px = xMin + (xMax - xMin) * (static_cast<double>(rand()) / RAND_MAX);
+            double py = yMin + (yMax - yMin) * (static_cast<double>(rand()) / RAND_MAX);
+            world.addParticle(ponto2D{px, py});
+        }else{
+            world.addParticle(ponto2D{0.0, 0.0});
+        }
+    }
 
-int main(){
     if (!glfwInit()) {
         std::cerr << "Erro ao inicializar GLFW" << std::endl;
         return -1;
@@ -363,26 +270,71 @@ int main(){
         }
     )";
         
-    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+    // Particulas: posição 2D e cor por vértice, todas desenhadas em uma chamada.
+    const char* particleVertexShaderSource = R"(
+        #version 430 core
+        layout (location = 0) in vec2 aPos;
+        layout (location = 1) in vec3 aColor;
+        uniform mat4 projection;
+        out vec3 vColor;
+        void main() {
+            gl_Position = projection * vec4(aPos, 0.0, 1.0);
+            vColor = aColor;
+        }
+    )";
 
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    const char* particleFragmentShaderSource = R"(
+        #version 430 core
+        in vec3 vColor;
+        out vec4 FragColor;
+        void main() {
+            FragColor = vec4(vColor, 1.0);
+        }
+    )";
 
-    int success;
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "Erro ao vincular shaders: " << infoLog << std::endl;
-    }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    unsigned int shaderProgram = createProgram(vertexShaderSource, fragmentShaderSource);
+    unsigned int particleShaderProgram = createProgram(particleVertexShaderSource, particleFragmentShaderSource);
 
     unsigned int cartesianVAO = setupCartesianPlane(xMin, xMax, yMin, yMax);
 
+    world.setThreadCount(0); // Usa todos os núcleos no passo da simulação
+
+    // As colisões são contadas (e opcionalmente gravadas) por uma thread de fundo.
+    CollisionLog collisionLog;
+    if(eventLog && !collisionLog.openFile(eventLog)){
+        std::cerr << "Não foi possível abrir " << eventLog << std::endl;
+    }
+    world.setCollisionLog(&collisionLog);
+    collisionLog.reserveSegments(world.getSegmentTable().size());
+    collisionLog.start();
+
+    ParticleRenderer particleRenderer;
+    particleRenderer.init((GLADloadproc)glfwGetProcAddress);
+    SegmentRenderer segmentRenderer;
+    segmentRenderer.init();
+    std::cout << "Buffer de posicoes: " << (particleRenderer.isPersistent() ? "mapeado persistente" : "orfanamento") << std::endl;
+
+#ifdef PARTICLE_PROFILE
+    ProfilerOverlay profilerOverlay;
+    profilerOverlay.init();
+    if(profileCsv && !FrameProfiler::instance().openCsv(profileCsv)){
+        std::cerr << "Não foi possível abrir " << profileCsv << std::endl;
+    }
+#else
+    if(profileCsv){
+        std::cerr << "--profile-csv ignorado: compile com make all PROFILE=1" << std::endl;
+    }
+#endif
+
+    // Tempo médio de frame, mostrado no título da janela a cada segundo.
+    double lastTitleTime = glfwGetTime();
+    int framesSinceTitle = 0;
+    AllocStats lastAllocs = allocationStats();
+
+    // A simulação avança em passos fixos, independente do vsync e da GPU.
+    SimulationClock simClock{1.0 / simHz, substeps, maxCatchUp};
+    double lastFrameTime = glfwGetTime();
+
     while (!glfwWindowShouldClose(window)) {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -394,33 +346,69 @@ int main(){
         glUniform3f(glGetUniformLocation(shaderProgram, "color"), 0.0f, 1.0f, 0.0f);
         glDrawArrays(GL_LINES, 0, 4);
 
-        moveParticles();
-        intersectWithLimits();
-        for(const auto& p : particles){
-            drawPoint(p.first, shaderProgram, projection, 0.5f, 0.5f, 0.5f);
+        double frameStart = glfwGetTime();
+        int steps = simClock.advance(frameStart - lastFrameTime);
+        lastFrameTime = frameStart;
+        {
+            PROFILE_SCOPE(ProfilePhase::Simulation);
+            for(int s = 0; s < steps; ++s){
+                world.step(simClock.get_stepDt());
+            }
+        }
+
+        {
+            PROFILE_SCOPE(ProfilePhase::Render);
+            particleRenderer.draw(world, particleShaderProgram, projection);
+            segmentRenderer.draw(world, shaderProgram, projection, 1.0f, 0.0f, 0.0f);
+        }
+#ifdef PARTICLE_PROFILE
+        profilerOverlay.draw(FrameProfiler::instance(), shaderProgram, 1000.0 / 60.0);
+#endif
+
+        {
+            PROFILE_SCOPE(ProfilePhase::Swap);
+            glfwSwapBuffers(window);
+            glfwPollEvents();
         }
-        if(!segs.empty()){
-            for(int i = 0; i < segs.size(); ++i){
-                drawPoint(segs[i], shaderProgram, projection, 1.0f, 0.0f, 0.0f);
+        PROFILE_END_FRAME();
+
+        ++framesSinceTitle;
+        double now = glfwGetTime();
+        if(now - lastTitleTime >= 1.0){
+            // Montado em um buffer fixo: o título não aloca, e a contagem de ALLOCS=1
+            // mostra só o que o laço em si alocou.
+            char title[512];
+            int len = std::snprintf(title, sizeof(title), "Particle Physics | %zu particulas | %.3f ms/frame | %llu colisoes",
+                                    world.getParticles().size(), 1000.0 * (now - lastTitleTime) / framesSinceTitle,
+                                    static_cast<unsigned long long>(collisionLog.get_consumed()));
+            if(allocationCountingEnabled()){
+                AllocStats allocs = allocationStats();
+                len += std::snprintf(title + len, sizeof(title) - len, " | %.1f aloc/frame",
+                                     static_cast<double>(allocs.count - lastAllocs.count) / framesSinceTitle);
+                lastAllocs = allocs;
             }
-            if(segs.size() % 2 == 0){
-                for(int i = 0; i < segs.size(); i = i + 2){
-                    drawSegment(segs[i], segs[i+1], shaderProgram, projection, 1.0f, 0.0f, 0.0f);
-                    checkIntersect(segs[i], segs[i+1]);
-                }  
-            }else{
-                for(int i = 0; i < segs.size() - 1; i = i + 2){
-                    drawSegment(segs[i], segs[i+1], shaderProgram, projection, 1.0f, 0.0f, 0.0f);
-                    checkIntersect(segs[i], segs[i+1]);
-                }
+#ifdef PARTICLE_PROFILE
+            // Média/p99 (ms) de cada fase, na ordem das barras do HUD.
+            for(int p = 0; p < static_cast<int>(ProfilePhase::COUNT) && len < static_cast<int>(sizeof(title)); ++p){
+                PhaseStats st = FrameProfiler::instance().stats(static_cast<ProfilePhase>(p));
+                len += std::snprintf(title + len, sizeof(title) - len, " | %s %.2f/%.2f",
+                                     FrameProfiler::phaseName(static_cast<ProfilePhase>(p)), st.avgMs, st.p99Ms);
             }
-
+#endif
+            glfwSetWindowTitle(window, title);
+            lastTitleTime = now;
+            framesSinceTitle = 0;
         }
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
     }
 
+    world.setCollisionLog(nullptr);
+    collisionLog.stop();
+    recorder.finish(world);
+    particleRenderer.release();
+    segmentRenderer.release();
+#ifdef PARTICLE_PROFILE
+    profilerOverlay.release();
+#endif
     glfwTerminate();
 
     return 0;